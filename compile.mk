@@ -6,6 +6,8 @@ include $(RACK_DIR)/arch.mk
 
 OBJCOPY ?= objcopy
 STRIP ?= strip
+# Directory of object and dependency files
+BUILD_DIR ?= build
 
 # Generate dependency files alongside the object files
 FLAGS += -MMD -MP
@@ -13,6 +15,16 @@ FLAGS += -MMD -MP
 FLAGS += -g
 # Optimization
 FLAGS += -O3 -march=nocona -funsafe-math-optimizations
+# Instruction set extensions beyond the baseline, used when building ISA variants of plugins
+ifdef ISA
+ifeq ($(ISA), avx2)
+	FLAGS += -mavx2 -mfma
+else ifeq ($(ISA), avx512)
+	FLAGS += -mavx512f -mavx512dq -mavx512bw -mavx512vl -mfma
+else
+$(error ISA "$(ISA)" is not recognized. Use avx2 or avx512)
+endif
+endif
 # Warnings
 FLAGS += -Wall -Wextra -Wno-unused-parameter
 # C++ standard
@@ -49,9 +61,9 @@ CFLAGS += $(FLAGS)
 CXXFLAGS += $(FLAGS)
 
 # Derive object files from sources and place them before user-defined objects
-OBJECTS := $(patsubst %, build/%.o, $(SOURCES)) $(OBJECTS)
-OBJECTS += $(patsubst %, build/%.bin.o, $(BINARIES))
-DEPENDENCIES := $(patsubst %, build/%.d, $(SOURCES))
+OBJECTS := $(patsubst %, $(BUILD_DIR)/%.o, $(SOURCES)) $(OBJECTS)
+OBJECTS += $(patsubst %, $(BUILD_DIR)/%.bin.o, $(BINARIES))
+DEPENDENCIES := $(patsubst %, $(BUILD_DIR)/%.d, $(SOURCES))
 
 # Final targets
 
@@ -60,23 +72,23 @@ $(TARGET): $(OBJECTS)
 
 -include $(DEPENDENCIES)
 
-build/%.c.o: %.c
+$(BUILD_DIR)/%.c.o: %.c
 	@mkdir -p $(@D)
 	$(CC) $(CFLAGS) -c -o $@ $<
 
-build/%.cpp.o: %.cpp
+$(BUILD_DIR)/%.cpp.o: %.cpp
 	@mkdir -p $(@D)
 	$(CXX) $(CXXFLAGS) -c -o $@ $<
 
-build/%.cc.o: %.cc
+$(BUILD_DIR)/%.cc.o: %.cc
 	@mkdir -p $(@D)
 	$(CXX) $(CXXFLAGS) -c -o $@ $<
 
-build/%.m.o: %.m
+$(BUILD_DIR)/%.m.o: %.m
 	@mkdir -p $(@D)
 	$(CC) $(CFLAGS) -c -o $@ $<
 
-build/%.bin.o: %
+$(BUILD_DIR)/%.bin.o: %
 	@mkdir -p $(@D)
 ifdef ARCH_LIN
 	$(OBJCOPY) -I binary -O elf64-x86-64 -B i386:x86-64 --rename-section .data=.rodata,alloc,load,readonly,data,contents $< $@
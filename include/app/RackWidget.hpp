@@ -41,6 +41,14 @@ struct RackWidget : widget::OpaqueWidget {
 	void clear();
 	json_t* toJson();
 	void fromJson(json_t* rootJ);
+	/** Creates and positions the ModuleWidgets of a patch without adding them to the rack.
+	Used to build a patch off-screen before swapping it in.
+	*/
+	std::vector<ModuleWidget*> modulesFromJson(json_t* rootJ);
+	/** Creates and positions a single ModuleWidget of a patch's "modules" array, or returns NULL if its model isn't installed. */
+	ModuleWidget* moduleWidgetFromJson(json_t* moduleJ, size_t moduleIndex);
+	/** Adds the cables of a patch whose modules have already been added. */
+	void cablesFromJson(json_t* rootJ);
 	void pastePresetClipboardAction();
 
 	// Module methods
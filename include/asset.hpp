@@ -31,6 +31,7 @@ extern std::string pluginsPath;
 extern std::string settingsPath;
 extern std::string autosavePath;
 extern std::string templatePath;
+extern std::string startupReportPath;
 // Only defined on Mac
 extern std::string bundlePath;
 
@@ -66,5 +66,20 @@ T approxExp2_taylor5(T x) {
 }
 
 
+/** Returns tan(pi * x), assuming that 0 <= x < 0.5.
+Useful for prewarping the cutoff of bilinear and zero-delay-feedback filters, where `x` is the cutoff frequency divided by the sample rate.
+Maximum 0.0001% error.
+Below x = 1/4, uses the (5, 4) Pade approximant of tan around 0.
+Above, uses tan(pi * x) = 1 / tan(pi * (1/2 - x)) so the approximant is only evaluated near 0.
+*/
+template <typename T>
+T approxTanPi_pade(T x) {
+	auto low = (x < 0.25f);
+	T y = T(M_PI) * simd::ifelse(low, x, 0.5f - x);
+	T y2 = y * y;
+	T t = y * (T(945) + y2 * (T(-105) + y2)) / (T(945) + y2 * (T(-420) + y2 * T(15)));
+	return simd::ifelse(low, t, 1.f / t);
+}
+
 } // namespace dsp
 } // namespace rack
@@ -6,8 +6,29 @@ namespace rack {
 namespace dsp {
 
 
-/** Detects when a boolean changes from false to true */
-struct BooleanTrigger {
+/** Detects when a boolean changes from false to true.
+For SIMD types, `state` is a mask of the channels which are high.
+*/
+template <typename T = float>
+struct TBooleanTrigger {
+	T state;
+	TBooleanTrigger() {
+		reset();
+	}
+	void reset() {
+		state = T::mask();
+	}
+	/** Returns a mask of the channels which changed from low to high. */
+	T process(T state) {
+		T triggered = state & ~this->state;
+		this->state = state;
+		return triggered;
+	}
+};
+
+
+template <>
+struct TBooleanTrigger<float> {
 	bool state = true;
 
 	void reset() {
@@ -21,6 +42,8 @@ struct BooleanTrigger {
 	}
 };
 
+typedef TBooleanTrigger<> BooleanTrigger;
+
 
 /** Turns HIGH when value reaches 1.f, turns LOW when value reaches 0.f. */
 template <typename T = float>
@@ -83,8 +106,37 @@ struct TSchmittTrigger<float> {
 typedef TSchmittTrigger<> SchmittTrigger;
 
 
-/** When triggered, holds a high value for a specified time before going low again */
-struct PulseGenerator {
+/** When triggered, holds a high value for a specified time before going low again.
+For SIMD types, each channel holds its own pulse, so one TPulseGenerator<float_4> replaces four PulseGenerators.
+*/
+template <typename T = float>
+struct TPulseGenerator {
+	T remaining;
+	TPulseGenerator() {
+		reset();
+	}
+	/** Immediately disables the pulses of all channels */
+	void reset() {
+		remaining = 0.f;
+	}
+	/** Advances the state by `deltaTime`. Returns a mask of the channels in the HIGH state. */
+	T process(float deltaTime) {
+		T high = (remaining > 0.f);
+		remaining -= simd::ifelse(high, deltaTime, 0.f);
+		return high;
+	}
+	/** Begins a trigger with the given `duration` in the channels set in `mask`.
+	Use simd::movemaskInverse<T>() to build a mask for a single channel.
+	*/
+	void trigger(T mask, T duration = 1e-3f) {
+		// Keep the previous pulse if the existing pulse will be held longer than the currently requested one.
+		remaining = simd::ifelse(mask, simd::fmax(remaining, duration), remaining);
+	}
+};
+
+
+template <>
+struct TPulseGenerator<float> {
 	float remaining = 0.f;
 
 	/** Immediately disables the pulse */
@@ -110,8 +162,32 @@ struct PulseGenerator {
 	}
 };
 
+typedef TPulseGenerator<> PulseGenerator;
+
 
-struct Timer {
+template <typename T = float>
+struct TTimer {
+	T time;
+	TTimer() {
+		reset();
+	}
+	void reset() {
+		time = 0.f;
+	}
+	/** Resets the channels set in `mask`. */
+	void reset(T mask) {
+		time = simd::ifelse(mask, 0.f, time);
+	}
+	/** Returns the time of each channel since its last reset or initialization. */
+	T process(float deltaTime) {
+		time += deltaTime;
+		return time;
+	}
+};
+
+
+template <>
+struct TTimer<float> {
 	float time = 0.f;
 
 	void reset() {
@@ -125,8 +201,51 @@ struct Timer {
 	}
 };
 
+typedef TTimer<> Timer;
+
+
+/** Counts clocks in each channel and fires when the channel's count reaches its division.
+The count is stored in T, so for float_4, divisions must be below 2^24.
+*/
+template <typename T = float>
+struct TClockDivider {
+	T clock;
+	T division;
+	TClockDivider() {
+		clock = 0.f;
+		division = 1.f;
+	}
+
+	void reset() {
+		clock = 0.f;
+	}
 
-struct ClockDivider {
+	void setDivision(T division) {
+		this->division = division;
+	}
+
+	T getDivision() {
+		return division;
+	}
+
+	T getClock() {
+		return clock;
+	}
+
+	/** Advances the channels set in `mask`, e.g. the channels triggered by a TSchmittTrigger.
+	Returns a mask of the channels which reached their division and reset.
+	*/
+	T process(T mask = T::mask()) {
+		clock += simd::ifelse(mask, 1.f, 0.f);
+		T reached = (clock >= division);
+		clock = simd::ifelse(reached, 0.f, clock);
+		return reached;
+	}
+};
+
+
+template <>
+struct TClockDivider<float> {
 	uint32_t clock = 0;
 	uint32_t division = 1;
 
@@ -157,6 +276,8 @@ struct ClockDivider {
 	}
 };
 
+typedef TClockDivider<> ClockDivider;
+
 
 } // namespace dsp
 } // namespace rack
@@ -0,0 +1,160 @@
+#pragma once
+#include <dsp/common.hpp>
+
+
+namespace rack {
+namespace dsp {
+
+
+/** Attack-decay-sustain-release envelope generator.
+Each segment approaches its target exponentially, advanced by a coefficient computed in setParameters(), so no `exp` is evaluated per sample.
+The attack aims past 1 so it reaches the peak in finite time, then the decay begins.
+For SIMD types, stage transitions are computed with masks, so a 16-voice envelope is four branch-free steps.
+
+Example:
+
+	dsp::TADSR<float_4> adsr[4];
+	...
+	for (int c = 0; c < channels; c += 4) {
+		float_4 gate = inputs[GATE_INPUT].getPolyVoltageSimd<float_4>(c) >= 1.f;
+		adsr[c / 4].setParameters(attack, decay, sustain, release, args.sampleTime);
+		float_4 env = adsr[c / 4].process(gate, retrig[c / 4]);
+		outputs[ENVELOPE_OUTPUT].setVoltageSimd(10.f * env, c);
+	}
+*/
+template <typename T = float>
+struct TADSR {
+	/** Output level in [0, 1] */
+	T env;
+	/** Mask of the lanes in the attack stage */
+	T attacking;
+	/** Mask of the gate from the previous step, for detecting rising edges */
+	T gate;
+	T attackLambda;
+	T decayLambda;
+	T releaseLambda;
+	T sustain;
+
+	/** Level the attack approaches. Higher values give a more linear attack. */
+	static constexpr float ATTACK_TARGET = 1.2f;
+
+	TADSR() {
+		reset();
+		setParameters(0.f, 0.f, 1.f, 0.f, 1.f);
+	}
+
+	void reset() {
+		env = 0.f;
+		attacking = 0.f;
+		gate = 0.f;
+	}
+
+	/** Sets the segment times in seconds and the sustain level in [0, 1].
+	`attack` is the time from 0 to the peak.
+	`decay` and `release` are the times to settle within 1% of their targets.
+	Evaluates `exp`, so call this at a lower rate than process() when possible.
+	*/
+	void setParameters(T attack, T decay, T sustain, T release, float sampleTime) {
+		// Time to go from 0 to 1 when approaching ATTACK_TARGET, in time constants
+		const float attackTaus = std::log(ATTACK_TARGET / (ATTACK_TARGET - 1.f));
+		const float settleTaus = std::log(100.f);
+		attackLambda = getLambda(attack / attackTaus, sampleTime);
+		decayLambda = getLambda(decay / settleTaus, sampleTime);
+		releaseLambda = getLambda(release / settleTaus, sampleTime);
+		this->sustain = simd::clamp(sustain, 0.f, 1.f);
+	}
+
+	static T getLambda(T tau, float sampleTime) {
+		return 1.f - simd::exp(-sampleTime / simd::fmax(tau, 1e-6f));
+	}
+
+	/** Advances the envelope by one sample and returns its level.
+	`gate` is a mask of the lanes with a high gate.
+	`retrigger` is a mask of the lanes whose attack should restart from the current level while the gate is held.
+	*/
+	T process(T gate, T retrigger = 0.f) {
+		T rise = simd::andnot(this->gate, gate);
+		// Leave the attack when the gate falls
+		attacking = (attacking & gate) | rise | (retrigger & gate);
+		this->gate = gate;
+
+		T target = simd::ifelse(attacking, ATTACK_TARGET, simd::ifelse(gate, sustain, 0.f));
+		T lambda = simd::ifelse(attacking, attackLambda, simd::ifelse(gate, decayLambda, releaseLambda));
+		env += (target - env) * lambda;
+
+		// Begin the decay at the peak
+		T peaked = (env >= 1.f);
+		attacking = simd::andnot(peaked, attacking);
+		env = simd::fmin(env, 1.f);
+		return env;
+	}
+};
+
+
+template <>
+struct TADSR<float> {
+	float env = 0.f;
+	bool attacking = false;
+	bool gate = false;
+	float attackLambda;
+	float decayLambda;
+	float releaseLambda;
+	float sustain;
+
+	static constexpr float ATTACK_TARGET = 1.2f;
+
+	TADSR() {
+		setParameters(0.f, 0.f, 1.f, 0.f, 1.f);
+	}
+
+	void reset() {
+		env = 0.f;
+		attacking = false;
+		gate = false;
+	}
+
+	void setParameters(float attack, float decay, float sustain, float release, float sampleTime) {
+		const float attackTaus = std::log(ATTACK_TARGET / (ATTACK_TARGET - 1.f));
+		const float settleTaus = std::log(100.f);
+		attackLambda = getLambda(attack / attackTaus, sampleTime);
+		decayLambda = getLambda(decay / settleTaus, sampleTime);
+		releaseLambda = getLambda(release / settleTaus, sampleTime);
+		this->sustain = math::clamp(sustain, 0.f, 1.f);
+	}
+
+	static float getLambda(float tau, float sampleTime) {
+		return 1.f - std::exp(-sampleTime / std::fmax(tau, 1e-6f));
+	}
+
+	float process(bool gate, bool retrigger = false) {
+		if (gate) {
+			if (!this->gate || retrigger)
+				attacking = true;
+		}
+		else {
+			attacking = false;
+		}
+		this->gate = gate;
+
+		if (attacking) {
+			env += (ATTACK_TARGET - env) * attackLambda;
+			if (env >= 1.f) {
+				env = 1.f;
+				attacking = false;
+			}
+		}
+		else if (gate) {
+			env += (sustain - env) * decayLambda;
+		}
+		else {
+			env += (0.f - env) * releaseLambda;
+		}
+		return env;
+	}
+};
+
+typedef TADSR<> ADSR;
+
+
+} // namespace dsp
+} // namespace rack
@@ -1,5 +1,6 @@
 #pragma once
 #include <dsp/common.hpp>
+#include <dsp/approx.hpp>
 
 
 namespace rack {
@@ -429,5 +430,140 @@ struct TBiquadFilter : IIRFilter<3, 3, T> {
 typedef TBiquadFilter<> BiquadFilter;
 
 
+/** State-variable filter with trapezoidal integration and zero-delay feedback.
+Unlike TBiquadFilter, the state stays valid when the cutoff changes, so the cutoff and Q can be modulated every sample at audio rate without instability.
+Computing the coefficients takes one approxTanPi_pade() and one division.
+See "Solving the continuous SVF equations using trapezoidal integration and equivalent currents" by Andrew Simper, https://cytomic.com/files/dsp/SvfLinearTrapOptimised2.pdf
+*/
+template <typename T = float>
+struct TSVFilter {
+	/** Integrator states */
+	T ic1eq;
+	T ic2eq;
+	T k;
+	T a1;
+	T a2;
+	T a3;
+	/** Outputs of the last process() call */
+	T v0;
+	T v1;
+	T v2;
+
+	TSVFilter() {
+		reset();
+		setParameters(0.25f, M_SQRT1_2);
+	}
+
+	void reset() {
+		ic1eq = 0.f;
+		ic2eq = 0.f;
+		v0 = 0.f;
+		v1 = 0.f;
+		v2 = 0.f;
+	}
+
+	/** Sets the cutoff and quality factor.
+	`f` is the ratio between the cutoff frequency and sample rate, i.e. f = f_c / f_s, and must be less than 0.5.
+	*/
+	void setParameters(T f, T Q) {
+		T g = approxTanPi_pade(f);
+		k = 1.f / Q;
+		a1 = 1.f / (1.f + g * (g + k));
+		a2 = g * a1;
+		a3 = g * a2;
+	}
+
+	void process(T x) {
+		v0 = x;
+		T v3 = v0 - ic2eq;
+		v1 = a1 * ic1eq + a2 * v3;
+		v2 = ic2eq + a2 * ic1eq + a3 * v3;
+		ic1eq = 2.f * v1 - ic1eq;
+		ic2eq = 2.f * v2 - ic2eq;
+	}
+	T lowpass() {
+		return v2;
+	}
+	T bandpass() {
+		return v1;
+	}
+	T highpass() {
+		return v0 - k * v1 - v2;
+	}
+	T notch() {
+		return v0 - k * v1;
+	}
+};
+
+typedef TSVFilter<> SVFilter;
+
+
+/** 4-pole ladder lowpass filter made of one-pole trapezoidal stages, with the global feedback solved without a unit delay.
+The filter is linear, and stable for any cutoff modulation and resonance below 4, where it self-oscillates.
+Apply saturation before the filter if you want the nonlinear character of an analog ladder.
+See chapter 5 of "The Art of VA Filter Design" by Vadim Zavalishin.
+*/
+template <typename T = float>
+struct TLadderFilter {
+	/** Integrator states of each stage */
+	T s[4];
+	/** Gain of each stage, g / (1 + g) */
+	T G;
+	T resonance;
+	/** Input of the first stage and outputs of each stage from the last process() call */
+	T y[5];
+
+	TLadderFilter() {
+		reset();
+		setParameters(0.25f, 0.f);
+	}
+
+	void reset() {
+		for (int i = 0; i < 4; i++) {
+			s[i] = 0.f;
+		}
+		for (int i = 0; i < 5; i++) {
+			y[i] = 0.f;
+		}
+	}
+
+	/** Sets the cutoff and resonance.
+	`f` is the ratio between the cutoff frequency and sample rate, i.e. f = f_c / f_s, and must be less than 0.5.
+	`resonance` is the feedback gain, from 0 to 4.
+	*/
+	void setParameters(T f, T resonance) {
+		T g = approxTanPi_pade(f);
+		G = g / (1.f + g);
+		this->resonance = resonance;
+	}
+
+	void process(T x) {
+		// Each stage outputs G * in + S, where S = s * (1 - G) depends only on the state.
+		// Compose them to solve for the output of the last stage as a function of the input of the first.
+		T oneMinusG = 1.f - G;
+		T S = s[0] * oneMinusG;
+		S = G * S + s[1] * oneMinusG;
+		S = G * S + s[2] * oneMinusG;
+		S = G * S + s[3] * oneMinusG;
+		T G2 = G * G;
+		y[0] = (x - resonance * S) / (1.f + resonance * G2 * G2);
+		for (int i = 0; i < 4; i++) {
+			T v = (y[i] - s[i]) * G;
+			y[i + 1] = v + s[i];
+			s[i] = y[i + 1] + v;
+		}
+	}
+	/** 4-pole lowpass output */
+	T lowpass() {
+		return y[4];
+	}
+	/** 4-pole highpass output, mixed from the stage outputs */
+	T highpass() {
+		return y[0] - 4.f * y[1] + 6.f * y[2] - 4.f * y[3] + y[4];
+	}
+};
+
+typedef TLadderFilter<> LadderFilter;
+
 } // namespace dsp
 } // namespace rack
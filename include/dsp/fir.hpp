@@ -1,6 +1,8 @@
 #pragma once
 #include <dsp/common.hpp>
 #include <pffft.h>
+#include <vector>
+#include <algorithm>
 
 
 namespace rack {
@@ -25,6 +27,111 @@ inline void boxcarLowpassIR(float* out, int len, float cutoff = 0.5f) {
 }
 
 
+/** Finite impulse response filter with a fixed kernel and its own history.
+For T = float_4, filters 4 channels with the same kernel, one channel per lane.
+The history is stored twice in a row, so the latest samples are always contiguous and no modulo is needed to read them.
+For float, the taps are multiplied 4 at a time with float_4.
+
+Example:
+
+	TFIRFilter<float_4> filter;
+	filter.setKernel(kernel, kernelLen);
+	float_4 out = filter.process(in);
+*/
+template <typename T = float>
+struct TFIRFilter {
+	/** Kernel in reverse order, padded with leading zeros to a multiple of 4 taps. */
+	std::vector<float> reversedKernel;
+	/** Two copies of the last `length` input samples. */
+	std::vector<T> history;
+	int length = 0;
+	int pos = 0;
+
+	TFIRFilter() {}
+	TFIRFilter(const float* kernel, int kernelLen) {
+		setKernel(kernel, kernelLen);
+	}
+
+	/** Copies the kernel and clears the history.
+	Must be called before processing.
+	*/
+	void setKernel(const float* kernel, int kernelLen) {
+		assert(kernelLen > 0);
+		length = (kernelLen + 3) / 4 * 4;
+		reversedKernel.assign(length, 0.f);
+		for (int i = 0; i < kernelLen; i++) {
+			reversedKernel[length - 1 - i] = kernel[i];
+		}
+		history.assign(2 * length, T(0.f));
+		pos = 0;
+	}
+
+	/** Clears the history. */
+	void reset() {
+		std::fill(history.begin(), history.end(), T(0.f));
+		pos = 0;
+	}
+
+	/** Returns the number of taps, rounded up to a multiple of 4. */
+	int getLength() {
+		return length;
+	}
+
+	/** Adds a sample to the history without computing an output. */
+	void push(T in) {
+		if (++pos >= length)
+			pos = 0;
+		history[pos] = in;
+		history[pos + length] = in;
+	}
+
+	/** Returns the output at the most recently pushed sample. */
+	T compute() {
+		return dot(&history[pos + 1], reversedKernel.data(), length);
+	}
+
+	T process(T in) {
+		push(in);
+		return compute();
+	}
+
+	/** Filters a block of `frames` samples. `in` and `out` may be the same buffer. */
+	void process(const T* in, T* out, int frames) {
+		for (int i = 0; i < frames; i++) {
+			push(in[i]);
+			out[i] = compute();
+		}
+	}
+
+	/** Filters `factor` samples and returns only the last output, computing one dot product instead of `factor`. */
+	T processDecimate(const T* in, int factor) {
+		for (int i = 0; i < factor; i++) {
+			push(in[i]);
+		}
+		return compute();
+	}
+
+	/** Multiply-accumulates `len` samples with the kernel. `len` must be a multiple of 4. */
+	static float dot(const float* x, const float* kernel, int len) {
+		simd::float_4 y = 0.f;
+		for (int i = 0; i < len; i += 4) {
+			y += simd::float_4::load(&x[i]) * simd::float_4::load(&kernel[i]);
+		}
+		return y[0] + y[1] + y[2] + y[3];
+	}
+
+	static simd::float_4 dot(const simd::float_4* x, const float* kernel, int len) {
+		simd::float_4 y = 0.f;
+		for (int i = 0; i < len; i++) {
+			y += x[i] * kernel[i];
+		}
+		return y;
+	}
+};
+
+typedef TFIRFilter<> FIRFilter;
+
+
 struct RealTimeConvolver {
 	// `kernelBlocks` number of contiguous FFT blocks of size `blockSize`
 	// indexed by [i * blockSize*2 + j]
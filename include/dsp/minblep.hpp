@@ -15,15 +15,32 @@ https://www.cs.cmu.edu/~eli/papers/icmc01-hardsync.pdf
 void minBlepImpulse(int z, int o, float* output);
 
 
+/** MinBLEP table shared by all generators with the same parameters, so the FFT-based computation runs once per parameter set rather than once per instance.
+*/
+template <int Z, int O>
+struct MinBlepImpulse {
+	float impulse[2 * Z * O + 1];
+
+	MinBlepImpulse() {
+		minBlepImpulse(Z, O, impulse);
+		impulse[2 * Z * O] = 1.f;
+	}
+
+	static const MinBlepImpulse& get() {
+		static const MinBlepImpulse table;
+		return table;
+	}
+};
+
+
 template <int Z, int O, typename T = float>
 struct MinBlepGenerator {
 	T buf[2 * Z] = {};
 	int pos = 0;
-	float impulse[2 * Z * O + 1];
+	const float* impulse;
 
 	MinBlepGenerator() {
-		minBlepImpulse(Z, O, impulse);
-		impulse[2 * Z * O] = 1.f;
+		impulse = MinBlepImpulse<Z, O>::get().impulse;
 	}
 
 	/** Places a discontinuity with magnitude `x` at -1 < p <= 0 relative to the current frame */
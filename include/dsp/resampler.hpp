@@ -5,6 +5,9 @@
 #include <dsp/window.hpp>
 #include <assert.h>
 #include <string.h>
+#include <map>
+#include <mutex>
+#include <vector>
 #include <speex/speex_resampler.h>
 
 
@@ -102,16 +105,37 @@ struct SampleRateConverter {
 };
 
 
+/** Blackman-Harris windowed lowpass kernels for Decimator and Upsampler, computed once and shared by all instances with the same length and cutoff.
+*/
+template <int LEN>
+struct LowpassKernel {
+	/** Returns the kernel with `cutoff` in units of the sample rate, computing it on first use.
+	The kernel remains valid for the lifetime of the program.
+	*/
+	static const float* get(float cutoff) {
+		static std::mutex mutex;
+		static std::map<float, std::vector<float>> kernels;
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<float>& kernel = kernels[cutoff];
+		if (kernel.empty()) {
+			kernel.resize(LEN);
+			boxcarLowpassIR(kernel.data(), LEN, cutoff);
+			blackmanHarrisWindow(kernel.data(), LEN);
+		}
+		return kernel.data();
+	}
+};
+
+
 /** Downsamples by an integer factor. */
 template <int OVERSAMPLE, int QUALITY, typename T = float>
 struct Decimator {
 	T inBuffer[OVERSAMPLE * QUALITY];
-	float kernel[OVERSAMPLE * QUALITY];
+	const float* kernel;
 	int inIndex;
 
 	Decimator(float cutoff = 0.9f) {
-		boxcarLowpassIR(kernel, OVERSAMPLE * QUALITY, cutoff * 0.5f / OVERSAMPLE);
-		blackmanHarrisWindow(kernel, OVERSAMPLE * QUALITY);
+		kernel = LowpassKernel<OVERSAMPLE * QUALITY>::get(cutoff * 0.5f / OVERSAMPLE);
 		reset();
 	}
 	void reset() {
@@ -141,12 +165,11 @@ struct Decimator {
 template <int OVERSAMPLE, int QUALITY>
 struct Upsampler {
 	float inBuffer[QUALITY];
-	float kernel[OVERSAMPLE * QUALITY];
+	const float* kernel;
 	int inIndex;
 
 	Upsampler(float cutoff = 0.9f) {
-		boxcarLowpassIR(kernel, OVERSAMPLE * QUALITY, cutoff * 0.5f / OVERSAMPLE);
-		blackmanHarrisWindow(kernel, OVERSAMPLE * QUALITY);
+		kernel = LowpassKernel<OVERSAMPLE * QUALITY>::get(cutoff * 0.5f / OVERSAMPLE);
 		reset();
 	}
 	void reset() {
@@ -176,5 +199,121 @@ struct Upsampler {
 };
 
 
+/** Windowed-sinc kernel tabulated at PHASES points per zero crossing, for SincInterpolator.
+Only the right half is stored since the kernel is symmetric.
+*/
+template <int ZERO_CROSSINGS, int PHASES>
+struct SincTable {
+	static constexpr int LENGTH = ZERO_CROSSINGS * PHASES;
+	/** Kernel values, padded with zeros so lookups past the last zero crossing return 0 */
+	float h[LENGTH + 2];
+	/** Differences between consecutive values, for linear interpolation between phases */
+	float dh[LENGTH + 2];
+
+	SincTable() {
+		for (int i = 0; i < LENGTH; i++) {
+			float x = (float) i / PHASES;
+			h[i] = sinc(x) * blackmanHarris(0.5f + 0.5f * x / ZERO_CROSSINGS);
+		}
+		h[LENGTH] = 0.f;
+		h[LENGTH + 1] = 0.f;
+		for (int i = 0; i < LENGTH + 1; i++) {
+			dh[i] = h[i + 1] - h[i];
+		}
+		dh[LENGTH + 1] = 0.f;
+	}
+
+	/** Returns the table shared by all interpolators with these parameters. */
+	static const SincTable& get() {
+		static const SincTable table;
+		return table;
+	}
+
+	/** Returns the kernel at `p` phases from its center. */
+	float lookup(float p) const {
+		p = std::fmin(p, (float) LENGTH);
+		int i = (int) p;
+		return h[i] + (p - i) * dh[i];
+	}
+
+	simd::float_4 lookup(simd::float_4 p) const {
+		p = simd::fmin(p, (float) LENGTH);
+		simd::int32_4 i = p;
+		simd::float_4 hi, dhi;
+		for (int v = 0; v < 4; v++) {
+			hi[v] = h[i[v]];
+			dhi[v] = dh[i[v]];
+		}
+		return hi + (p - simd::float_4(i)) * dhi;
+	}
+};
+
+
+/** Reads a buffer at fractional positions with a band-limited windowed-sinc kernel, for sample playback and varispeed delays.
+The playback `ratio` (input samples per output sample) can change every sample.
+Ratios above 1 widen the kernel to lower its cutoff, so pitching up does not alias, up to `maxRatio`.
+All interpolators with the same ZERO_CROSSINGS and PHASES share one table.
+
+Positions are split into an integer index and a fraction in [0, 1), so long buffers keep sub-sample precision.
+Samples outside of [0, len) are read as 0.
+
+Example of a sampler voice:
+
+	SincInterpolator<> interpolator;
+	float out = interpolator.process(sample, sampleLen, index, frac, ratio);
+	frac += ratio;
+	index += (int) frac;
+	frac -= (int) frac;
+*/
+template <int ZERO_CROSSINGS = 8, int PHASES = 256>
+struct SincInterpolator {
+	typedef SincTable<ZERO_CROSSINGS, PHASES> Table;
+	const Table* table;
+	float maxRatio = 4.f;
+
+	SincInterpolator() : table(&Table::get()) {}
+
+	float process(const float* buffer, int len, int index, float frac, float ratio) {
+		float scale = 1.f / math::clamp(ratio, 1.f, maxRatio);
+		float step = PHASES * scale;
+		int taps = (int) std::ceil(ZERO_CROSSINGS / scale);
+		float y = 0.f;
+		// Left wing, at distances frac, frac + 1, ... from buffer[index], buffer[index - 1], ...
+		int jStart = std::max(0, index - len + 1);
+		int jEnd = std::min(taps, index + 1);
+		for (int j = jStart; j < jEnd; j++) {
+			y += buffer[index - j] * table->lookup((frac + j) * step);
+		}
+		// Right wing, at distances 1 - frac, 2 - frac, ... from buffer[index + 1], buffer[index + 2], ...
+		jStart = std::max(0, -index - 1);
+		jEnd = std::min(taps, len - index - 1);
+		for (int j = jStart; j < jEnd; j++) {
+			y += buffer[index + 1 + j] * table->lookup((1.f - frac + j) * step);
+		}
+		return y * scale;
+	}
+
+	/** Reads 4 voices at once, each with its own position and ratio. */
+	simd::float_4 process(const float* buffer, int len, simd::int32_4 index, simd::float_4 frac, simd::float_4 ratio) {
+		simd::float_4 scale = 1.f / simd::clamp(ratio, 1.f, maxRatio);
+		simd::float_4 step = PHASES * scale;
+		int taps = (int) std::ceil(ZERO_CROSSINGS * std::fmin(std::fmax(std::fmax(ratio[0], ratio[1]), std::fmax(ratio[2], ratio[3])), maxRatio));
+		taps = std::max(taps, ZERO_CROSSINGS);
+		simd::float_4 y = 0.f;
+		for (int j = 0; j < taps; j++) {
+			simd::float_4 left, right;
+			for (int v = 0; v < 4; v++) {
+				int k = index[v] - j;
+				left[v] = (0 <= k && k < len) ? buffer[k] : 0.f;
+				k = index[v] + 1 + j;
+				right[v] = (0 <= k && k < len) ? buffer[k] : 0.f;
+			}
+			y += left * table->lookup((frac + j) * step);
+			y += right * table->lookup((1.f - frac + j) * step);
+		}
+		return y * scale;
+	}
+};
+
 } // namespace dsp
 } // namespace rack
@@ -0,0 +1,287 @@
+#pragma once
+#include <dsp/common.hpp>
+#include <vector>
+
+
+namespace rack {
+namespace dsp {
+
+
+/*
+Antiderivative antialiasing (ADAA) replaces a waveshaper y = f(x) with the average of f over the line segment between consecutive input samples, computed from antiderivatives of f.
+This suppresses aliasing of the harmonics f generates without oversampling.
+See "Antiderivative Antialiasing for Memoryless Nonlinearities" by Bilbao, Esqueda, Parker, and Valimaki, and "Reducing the Aliasing of Nonlinear Waveshaping Using Continuous-Time Convolution" by Parker, Zavalishin, and Le Bivic.
+
+A shape provides `f(x)`, its antiderivative `F1(x)`, and its second antiderivative `F2(x)`, for float and float_4.
+*/
+
+
+/** Clips to [-1, 1]. */
+struct HardClipShape {
+	template <typename T>
+	T f(T x) const {
+		return simd::clamp(x, -1.f, 1.f);
+	}
+	template <typename T>
+	T F1(T x) const {
+		T a = simd::fabs(x);
+		return simd::ifelse(a <= 1.f, 0.5f * x * x, a - 0.5f);
+	}
+	template <typename T>
+	T F2(T x) const {
+		T a = simd::fabs(x);
+		// sgn(x) (x^2/2 + 1/6) - x/2 outside of [-1, 1]
+		T outer = (0.5f * a * a + 1.f / 6) - 0.5f * a;
+		return simd::ifelse(a <= 1.f, x * x * x / 6, simd::ifelse(x < 0.f, -outer, outer));
+	}
+};
+
+
+/** Hyperbolic tangent. */
+struct TanhShape {
+	template <typename T>
+	T f(T x) const {
+		return 1.f - 2.f / (simd::exp(2.f * x) + 1.f);
+	}
+	/** log(cosh(x)), written to avoid overflow for large x */
+	template <typename T>
+	T F1(T x) const {
+		T a = simd::fabs(x);
+		return a + simd::log(1.f + simd::exp(-2.f * a)) - T(M_LN2);
+	}
+	template <typename T>
+	T F2(T x) const {
+		T a = simd::fabs(x);
+		T e = simd::exp(-2.f * a);
+		T y = 0.5f * a * a - T(M_LN2) * a + 0.5f * dilogNeg(e) + T(M_PI * M_PI / 24);
+		return simd::ifelse(x < 0.f, -y, y);
+	}
+	/** Returns Li2(-y) for 0 <= y <= 1, using the Landen identity Li2(-y) = -log(1 + y)^2 / 2 - Li2(y / (1 + y)), whose series converges quickly. */
+	template <typename T>
+	static T dilogNeg(T y) {
+		T l = simd::log(1.f + y);
+		T w = y / (1.f + y);
+		// Li2(w) = sum w^k / k^2, with w <= 1/2
+		T s = 1.f / (16 * 16);
+		for (int k = 15; k >= 1; k--) {
+			s = 1.f / (k * k) + w * s;
+		}
+		return -0.5f * l * l - w * s;
+	}
+};
+
+
+/** Cubic soft clip, x - x^3/3 in [-1, 1], saturating to +-2/3 outside. */
+struct CubicShape {
+	template <typename T>
+	T f(T x) const {
+		T c = simd::clamp(x, -1.f, 1.f);
+		return c - c * c * c / 3;
+	}
+	template <typename T>
+	T F1(T x) const {
+		T a = simd::fabs(x);
+		T x2 = x * x;
+		return simd::ifelse(a <= 1.f, x2 / 2 - x2 * x2 / 12, 2.f / 3 * a - 0.25f);
+	}
+	template <typename T>
+	T F2(T x) const {
+		T a = simd::fabs(x);
+		T x2 = x * x;
+		// sgn(x) (x^2/3 + 1/15) - x/4 outside of [-1, 1]
+		T outer = (x2 / 3 + 1.f / 15) - 0.25f * a;
+		return simd::ifelse(a <= 1.f, x * x2 / 6 - x * x2 * x2 / 60, simd::ifelse(x < 0.f, -outer, outer));
+	}
+};
+
+
+/** Arbitrary shape from a table of `f` sampled uniformly over [xMin, xMax], linearly interpolated, and constant outside of the range.
+The antiderivative tables are integrated exactly from the interpolated `f` when the table is set.
+*/
+struct TableShape {
+	std::vector<float> fTable;
+	std::vector<float> F1Table;
+	std::vector<float> F2Table;
+	float xMin = -1.f;
+	float xMax = 1.f;
+	float h = 1.f;
+
+	TableShape() {
+		// Identity over [-1, 1], which clips like HardClipShape
+		const float f[] = {-1.f, 1.f};
+		setTable(f, 2, -1.f, 1.f);
+	}
+
+	/** Copies `len` samples of f, where f[0] = f(xMin) and f[len - 1] = f(xMax). */
+	void setTable(const float* f, int len, float xMin, float xMax) {
+		assert(len >= 2);
+		this->xMin = xMin;
+		this->xMax = xMax;
+		h = (xMax - xMin) / (len - 1);
+		fTable.assign(f, f + len);
+		F1Table.resize(len);
+		F2Table.resize(len);
+		// Integrate in double so the error doesn't accumulate over long tables
+		double F1 = 0.0;
+		double F2 = 0.0;
+		for (int i = 0; i < len; i++) {
+			F1Table[i] = F1;
+			F2Table[i] = F2;
+			if (i + 1 < len) {
+				double d = f[i + 1] - f[i];
+				F2 += F1 * h + h * h * (f[i] / 2.0 + d / 6.0);
+				F1 += h * (f[i] + d / 2.0);
+			}
+		}
+	}
+
+	/** Finds the cell of `x` and the position `t` in it, where t is outside of [0, 1] beyond the ends of the table. */
+	int getCell(float x, float* t) const {
+		float p = (x - xMin) / h;
+		int i = math::clamp((int) std::floor(p), 0, (int) fTable.size() - 2);
+		*t = p - i;
+		return i;
+	}
+
+	float f(float x) const {
+		float t;
+		int i = getCell(x, &t);
+		t = math::clamp(t, 0.f, 1.f);
+		return fTable[i] + (fTable[i + 1] - fTable[i]) * t;
+	}
+	float F1(float x) const {
+		float t;
+		int i = getCell(x, &t);
+		if (t < 0.f) {
+			return F1Table[0] + fTable[0] * t * h;
+		}
+		if (t > 1.f) {
+			t -= 1.f;
+			return F1Table[i + 1] + fTable[i + 1] * t * h;
+		}
+		float d = fTable[i + 1] - fTable[i];
+		return F1Table[i] + h * t * (fTable[i] + d * t / 2);
+	}
+	float F2(float x) const {
+		float t;
+		int i = getCell(x, &t);
+		if (t < 0.f) {
+			return F2Table[0] + h * t * (F1Table[0] + fTable[0] * h * t / 2);
+		}
+		if (t > 1.f) {
+			t -= 1.f;
+			return F2Table[i + 1] + h * t * (F1Table[i + 1] + fTable[i + 1] * h * t / 2);
+		}
+		float d = fTable[i + 1] - fTable[i];
+		return F2Table[i] + h * t * (F1Table[i] + h * t * (fTable[i] / 2 + d * t / 6));
+	}
+
+	simd::float_4 f(simd::float_4 x) const {
+		return simd::float_4(f(x[0]), f(x[1]), f(x[2]), f(x[3]));
+	}
+	simd::float_4 F1(simd::float_4 x) const {
+		return simd::float_4(F1(x[0]), F1(x[1]), F1(x[2]), F1(x[3]));
+	}
+	simd::float_4 F2(simd::float_4 x) const {
+		return simd::float_4(F2(x[0]), F2(x[1]), F2(x[2]), F2(x[3]));
+	}
+};
+
+
+/** First-order ADAA waveshaper.
+Delays the signal by half a sample.
+When consecutive inputs are too close for the divided difference to be accurate, evaluates f at their midpoint instead.
+
+Example:
+
+	TADAA1Waveshaper<TanhShape, float_4> shaper;
+	float_4 out = shaper.process(in * drive);
+*/
+template <class TShape, typename T = float>
+struct TADAA1Waveshaper {
+	TShape shape;
+	/** Differences between consecutive inputs below this use the fallback. */
+	float epsilon = 1e-3f;
+	T x1;
+	T F1x1;
+
+	TADAA1Waveshaper() {
+		reset();
+	}
+
+	void reset() {
+		x1 = 0.f;
+		F1x1 = shape.F1(x1);
+	}
+
+	T process(T x) {
+		T F1x = shape.F1(x);
+		T dx = x - x1;
+		auto ill = (simd::fabs(dx) < epsilon);
+		T y = simd::ifelse(ill, shape.f(0.5f * (x + x1)), (F1x - F1x1) / simd::ifelse(ill, 1.f, dx));
+		x1 = x;
+		F1x1 = F1x;
+		return y;
+	}
+};
+
+
+/** Second-order ADAA waveshaper, which suppresses aliasing more than first order at the cost of a second antiderivative.
+Delays the signal by one sample.
+Ill-conditioned divided differences fall back to expansions around the midpoints of the inputs.
+*/
+template <class TShape, typename T = float>
+struct TADAA2Waveshaper {
+	TShape shape;
+	/** Differences between inputs below this use the fallbacks.
+	F2 loses precision to cancellation in float, so this is larger than for first order.
+	*/
+	float epsilon = 1e-2f;
+	T x1;
+	T x2;
+	T F2x1;
+	/** First divided difference of F2 between x1 and x2 */
+	T D1;
+
+	TADAA2Waveshaper() {
+		reset();
+	}
+
+	void reset() {
+		x1 = 0.f;
+		x2 = 0.f;
+		F2x1 = shape.F2(x1);
+		D1 = shape.F1(x1);
+	}
+
+	T process(T x) {
+		T F2x = shape.F2(x);
+		// First divided difference of F2 between x and x1, or F1 at their midpoint
+		T dx = x - x1;
+		auto ill = (simd::fabs(dx) < epsilon);
+		T D0 = simd::ifelse(ill, shape.F1(0.5f * (x + x1)), (F2x - F2x1) / simd::ifelse(ill, 1.f, dx));
+
+		// Second divided difference
+		T dx2 = x - x2;
+		auto ill2 = (simd::fabs(dx2) < epsilon);
+		T y = 2.f * (D0 - D1) / simd::ifelse(ill2, 1.f, dx2);
+
+		// When x is close to x2, expand around their midpoint
+		T xBar = 0.5f * (x + x2);
+		T delta = xBar - x1;
+		auto ill3 = (simd::fabs(delta) < epsilon);
+		T yBar = 2.f / simd::ifelse(ill3, 1.f, delta) * (shape.F1(xBar) + (F2x1 - shape.F2(xBar)) / simd::ifelse(ill3, 1.f, delta));
+		yBar = simd::ifelse(ill3, shape.f(0.5f * (xBar + x1)), yBar);
+		y = simd::ifelse(ill2, yBar, y);
+
+		x2 = x1;
+		x1 = x;
+		F2x1 = F2x;
+		D1 = D0;
+		return y;
+	}
+};
+
+
+} // namespace dsp
+} // namespace rack
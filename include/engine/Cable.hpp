@@ -13,6 +13,16 @@ struct Cable {
 	int outputId;
 	Module* inputModule = NULL;
 	int inputId;
+
+	/** Frames by which the engine delays the cable's voltages, to compensate for the latency of parallel paths.
+	Unstable API. Set by the engine.
+	*/
+	int compensationDelay = 0;
+	/** Ring of `compensationDelay` frames, each storing the channel count, event mask, and voltages of the output.
+	Unstable API.
+	*/
+	std::vector<float> delayBuffer;
+	int delayIndex = 0;
 };
 
 
@@ -20,6 +20,11 @@ struct Engine {
 	void start();
 	/** Stops engine thread. */
 	void stop();
+	/** Prevents the engine from stepping until unlock() is called, so that several changes (e.g. replacing every module) take effect between the same two blocks.
+	Other Engine methods may be called by the same thread while locked.
+	*/
+	void lock();
+	void unlock();
 	void setPaused(bool paused);
 	bool isPaused();
 	float getSampleRate();
@@ -27,9 +32,41 @@ struct Engine {
 	float getSampleTime();
 	/** Causes worker threads to block on a mutex instead of spinlock.
 	Call this in your Module::step() method to hint that the operation will take more than ~0.1 ms.
+	This also tells the engine that a module is pacing it with an external clock (e.g. an audio device), so it stops pacing itself with the system clock.
 	*/
 	void yieldWorkers();
 	uint64_t getFrame();
+	/** Sets the module whose device clocks the engine, e.g. the first audio interface with an open device, or NULL.
+	A module is only set if there is no primary module yet, so modules on different threads can claim it safely.
+	Returns whether `module` is now the primary module.
+	Cleared when the module is removed.
+	*/
+	bool setPrimaryModule(Module* module);
+	Module* getPrimaryModule();
+	/** Sets the sample rate of the primary module's device, which the engine uses when the sample rate setting is Auto.
+	The engine switches to it at the next block, so a device rate change results in one Module::onSampleRateChange() call.
+	*/
+	void setSuggestedSampleRate(float sampleRate);
+	/** Recomputes cable delays if the cable graph or a module's latency has changed.
+	This allocates the cables' delay buffers, so it is called by the UI thread each frame rather than by the engine thread.
+	*/
+	void updateLatencyCompensation();
+	/** Calls `f(i)` for each 0 <= i < n, sharing the calls with engine worker threads which have finished stepping their modules and are idle until the next frame.
+	Call this in your Module::process() method to split heavy work such as voices, grains, or FFT bins across cores.
+	Calls from other threads, such as Module::processBlock(), run all calls on the calling thread.
+	Returns when all calls have finished.
+	Each call should be a substantial chunk of work, since distributing it costs roughly an atomic operation.
+	The calls for different `i` run concurrently and must be independent.
+	They are attributed to the calling module's memory Counter, and in deterministic mode each `i` draws from its own random stream derived from the module's.
+	If there is one engine thread or another module is already using the workers, all calls run on the calling thread.
+	*/
+	template <typename F>
+	void parallelFor(int n, F f) {
+		parallelFor(n, [](void* context, int i) {
+			(*(F*) context)(i);
+		}, &f);
+	}
+	void parallelFor(int n, void (*f)(void* context, int i), void* context);
 
 	// Modules
 	/** Adds a module to the rack engine.
@@ -6,7 +6,9 @@
 #include <engine/Port.hpp>
 #include <engine/Light.hpp>
 #include <engine/ParamQuantity.hpp>
+#include <memory.hpp>
 #include <vector>
+#include <array>
 #include <jansson.h>
 
 
@@ -30,6 +32,7 @@ struct Module {
 
 	/** Arrays of components.
 	Initialized with config().
+	Empty if the module is a TModule, which stores its components inline, so use getParam(), getInput(), etc. to access any Module.
 	*/
 	std::vector<Param> params;
 	std::vector<Output> outputs;
@@ -80,6 +83,67 @@ struct Module {
 	*/
 	bool bypass = false;
 
+	/** Importance of the Module when the engine cannot keep up with real time.
+	Set this in your Module constructor.
+	*/
+	enum Priority {
+		/** Degraded and suspended first, e.g. scopes and other visualizers. */
+		PRIORITY_LOW,
+		PRIORITY_NORMAL,
+		/** Never degraded or suspended, e.g. audio and MIDI interfaces. */
+		PRIORITY_CRITICAL,
+	};
+	Priority priority = PRIORITY_NORMAL;
+	/** Seconds of CPU time per sample the Module is expected to use, or 0 for no budget.
+	When the engine sheds load, modules over their budget are degraded before others of the same priority.
+	*/
+	float cpuBudget = 0.f;
+	/** Quality level requested by the engine when shedding load, where 0 is full quality.
+	Module subclasses should not write this variable.
+	*/
+	int degradeLevel = 0;
+	/** Whether the Module is skipped from stepping by the engine to shed load.
+	Module subclasses should not read/write this variable.
+	*/
+	bool suspended = false;
+	/** ID of the first output found with a NaN, infinite, or denormal voltage while its inputs were valid, or -1 if none.
+	Only written when the engine checks voltages. Cleared when the Module is reset.
+	*/
+	int faultOutputId = -1;
+	/** State of the Module's own random number stream, used by random::uniform() etc. in process() when the engine is in deterministic mode.
+	Seeded from the engine's random seed and the Module ID.
+	Module subclasses should not read/write this variable.
+	*/
+	uint64_t randomState[2] = {};
+	/** Heap bytes allocated by the Module's constructor, process(), and dataFromJson() which haven't been freed yet.
+	Set by Model::createModule(), or NULL if the Module was constructed another way. Released when the Module is deleted.
+	Unstable API. Use getMemoryUsage() instead.
+	*/
+	memory::Counter* memoryCounter = NULL;
+	/** Frames per block if the Module is an asynchronous block processor, or 0. See configAsync(). */
+	int asyncBlockSize = 0;
+	/** Blocks between collecting an input block and outputting the result of processing it. */
+	int asyncLatency = 0;
+	/** Engine state of an asynchronous block processor, or NULL if the Module is not added to the engine.
+	Unstable API.
+	*/
+	struct AsyncState;
+	AsyncState* asyncState = NULL;
+	// Fields added since v1.0 go after the others, so plugins built against older headers keep the offsets of the original fields.
+	/** Pointers to the first element of each component array, wherever it is stored.
+	Unstable API. Use getParam(), getInput(), etc. instead.
+	*/
+	Param* paramsData = NULL;
+	Input* inputsData = NULL;
+	Output* outputsData = NULL;
+	Light* lightsData = NULL;
+	int numParams = 0;
+	int numInputs = 0;
+	int numOutputs = 0;
+	int numLights = 0;
+	/** Buses of wide outputs, owned by the Module so they outlive the component arrays of a TModule. */
+	std::vector<WideBus*> wideBuses;
+
 	/** Constructs a Module with no params, inputs, outputs, and lights. */
 	Module();
 	/** Use config() instead. */
@@ -90,14 +154,30 @@ struct Module {
 
 	/** Configures the number of Params, Outputs, Inputs, and Lights. */
 	void config(int numParams, int numInputs, int numOutputs, int numLights = 0);
+	/** Sets the component arrays to storage owned by a subclass, and initializes their ParamQuantities.
+	Called by TModule. Use config() instead.
+	*/
+	void configArrays(Param* params, int numParams, Input* inputs, int numInputs, Output* outputs, int numOutputs, Light* lights, int numLights);
+	/** Allows an output to carry up to `maxChannels` channels on one cable.
+	See Output::setWideChannels() and Output::getWideVoltages().
+	*/
+	void configWideOutput(int outputId, int maxChannels);
+	/** Allows an input to read all channels of a connected wide output with Input::getWideVoltages(). */
+	void configWideInput(int inputId);
+	/** Makes the Module an asynchronous block processor, for heavy DSP such as large FFTs which would otherwise stall every other module at each sample.
+	The engine collects the inputs of `blockSize` frames, calls processBlock() with them on a dedicated thread, and outputs the result `latency` blocks later, so the output is delayed by `latency * blockSize` frames.
+	processBlock() has `latency - 1` blocks to finish before the engine waits for it, so `latency` must be at least 2.
+	process() is not called.
+	*/
+	void configAsync(int blockSize, int latency = 2);
 
 	template <class TParamQuantity = ParamQuantity>
 	void configParam(int paramId, float minValue, float maxValue, float defaultValue, std::string label = "", std::string unit = "", float displayBase = 0.f, float displayMultiplier = 1.f, float displayOffset = 0.f) {
-		assert(paramId < (int) params.size() && paramId < (int) paramQuantities.size());
+		assert(paramId < numParams && paramId < (int) paramQuantities.size());
 		if (paramQuantities[paramId])
 			delete paramQuantities[paramId];
 
-		Param* p = &params[paramId];
+		Param* p = &paramsData[paramId];
 		p->value = defaultValue;
 
 		ParamQuantity* q = new TParamQuantity;
@@ -117,11 +197,71 @@ struct Module {
 		paramQuantities[paramId] = q;
 	}
 
+	int getNumParams() {
+		return numParams;
+	}
+	int getNumInputs() {
+		return numInputs;
+	}
+	int getNumOutputs() {
+		return numOutputs;
+	}
+	int getNumLights() {
+		return numLights;
+	}
+	Param& getParam(int index) {
+		return paramsData[index];
+	}
+	Input& getInput(int index) {
+		return inputsData[index];
+	}
+	Output& getOutput(int index) {
+		return outputsData[index];
+	}
+	Light& getLight(int index) {
+		return lightsData[index];
+	}
+	/** Returns the heap bytes currently attributed to the Module, or 0 if they are not tracked. */
+	int64_t getMemoryUsage() {
+		if (!memoryCounter)
+			return 0;
+		return memoryCounter->bytes.load(std::memory_order_relaxed);
+	}
+
 	struct ProcessArgs {
 		float sampleRate;
 		float sampleTime;
 	};
 
+	/** Input and output voltages of one block of an asynchronous block processor.
+	Voltages are stored in PORT_MAX_CHANNELS floats for each frame, with all frames of each port together.
+	*/
+	struct ProcessBlockArgs {
+		float sampleRate;
+		float sampleTime;
+		int frames;
+		const float* inputVoltages;
+		/** Channels of each input at the start of the block */
+		const uint8_t* inputChannels;
+		/** Zeroed before processBlock() is called */
+		float* outputVoltages;
+		/** Set to 1 before processBlock() is called */
+		uint8_t* outputChannels;
+
+		float getInputVoltage(int inputId, int frame, int channel = 0) const {
+			return inputVoltages[(inputId * frames + frame) * PORT_MAX_CHANNELS + channel];
+		}
+		int getInputChannels(int inputId) const {
+			return inputChannels[inputId];
+		}
+		void setOutputVoltage(int outputId, int frame, float voltage, int channel = 0) const {
+			outputVoltages[(outputId * frames + frame) * PORT_MAX_CHANNELS + channel] = voltage;
+		}
+		void setOutputChannels(int outputId, int channels) const {
+			outputChannels[outputId] = channels;
+		}
+	};
+
 	/** Advances the module by one audio sample.
 	Override this method to read Inputs and Params and to write Outputs and Lights.
 	*/
@@ -133,6 +273,11 @@ struct Module {
 	}
 	/** Override process(const ProcessArgs &args) instead. */
 	DEPRECATED virtual void step() {}
+	/** Processes a block of frames if the Module is configured with configAsync().
+	Called on the Module's own thread, so it may run concurrently with the UI and with other modules.
+	Params may be read and Lights may be written here.
+	*/
+	virtual void processBlock(const ProcessBlockArgs& args) {}
 
 	/** Called when the engine sample rate is changed. */
 	virtual void onSampleRateChange() {}
@@ -144,6 +289,20 @@ struct Module {
 	virtual void onAdd() {}
 	/** Called when the Module is removed from the Engine */
 	virtual void onRemove() {}
+	/** Called when the engine is overloaded and changes the quality level of the Module.
+	Reduce CPU usage as `level` increases (e.g. lower oversampling or fewer voices), and restore full quality when it returns to 0.
+	Return false if the Module cannot degrade to `level`, so the engine suspends it instead.
+	*/
+	virtual bool onDegrade(int level) {
+		return false;
+	}
+	/** Returns the number of frames by which the Module delays its outputs relative to its inputs, e.g. due to oversampling filters or FFT blocks.
+	The engine delays cables on parallel paths with less latency so that they arrive at other modules aligned.
+	Polled by the engine at each block, so the latency may change with the Module's settings.
+	*/
+	virtual int getLatency() {
+		return asyncBlockSize * asyncLatency;
+	}
 
 	json_t* toJson();
 	void fromJson(json_t* rootJ);
@@ -156,5 +315,65 @@ struct Module {
 };
 
 
+/** A Module with a compile-time number of components, stored inline rather than in heap-allocated vectors.
+This keeps Params, Ports, and Lights contiguous with your DSP state, and allows the compiler to unroll loops over them.
+Use it instead of Module and config(), and access components with getParam(), getInput(), getOutput(), and getLight():
+
+	struct MyModule : TModule<NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS> {
+		MyModule() {
+			configParam(PITCH_PARAM, -3.f, 3.f, 0.f);
+		}
+		void process(const ProcessArgs& args) override {
+			float pitch = getParam(PITCH_PARAM).getValue();
+		}
+	};
+
+Module's `params`, `inputs`, `outputs`, and `lights` vectors are empty, so they are hidden from subclasses.
+*/
+template <int NUM_PARAMS, int NUM_INPUTS, int NUM_OUTPUTS, int NUM_LIGHTS = 0>
+struct TModule : Module {
+	std::array<Param, NUM_PARAMS> paramStorage;
+	std::array<Input, NUM_INPUTS> inputStorage;
+	std::array<Output, NUM_OUTPUTS> outputStorage;
+	std::array<Light, NUM_LIGHTS> lightStorage;
+
+	TModule() {
+		configArrays(paramStorage.data(), NUM_PARAMS, inputStorage.data(), NUM_INPUTS, outputStorage.data(), NUM_OUTPUTS, lightStorage.data(), NUM_LIGHTS);
+	}
+
+	// Same as Module's accessors, but indexing the inline arrays directly
+	int getNumParams() {
+		return NUM_PARAMS;
+	}
+	int getNumInputs() {
+		return NUM_INPUTS;
+	}
+	int getNumOutputs() {
+		return NUM_OUTPUTS;
+	}
+	int getNumLights() {
+		return NUM_LIGHTS;
+	}
+	Param& getParam(int index) {
+		return paramStorage[index];
+	}
+	Input& getInput(int index) {
+		return inputStorage[index];
+	}
+	Output& getOutput(int index) {
+		return outputStorage[index];
+	}
+	Light& getLight(int index) {
+		return lightStorage[index];
+	}
+
+private:
+	using Module::params;
+	using Module::inputs;
+	using Module::outputs;
+	using Module::lights;
+};
+
+
 } // namespace engine
 } // namespace rack
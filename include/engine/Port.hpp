@@ -11,6 +11,32 @@ namespace engine {
 static const int PORT_MAX_CHANNELS = 16;
 
 
+/** Voltage storage for a wide bus output, which carries more than PORT_MAX_CHANNELS channels on one cable.
+The output module writes `back` while connected inputs read `front`, and the engine swaps them before each frame.
+This gives wide buses the same 1-sample cable latency as normal ports without copying their voltages.
+*/
+struct WideBus {
+	int maxChannels;
+	/** Number of channels in `front`, read by connected inputs */
+	int frontChannels = 0;
+	/** Number of channels in `back`, set by the output module */
+	int backChannels = 0;
+	/** Aligned to 32 bytes, with room for `maxChannels` rounded up to a multiple of 8. */
+	float* front;
+	float* back;
+	/** Unaligned allocation containing both buffers */
+	float* storage;
+
+	WideBus(int maxChannels);
+	~WideBus();
+	void flip() {
+		std::swap(front, back);
+		// The output keeps its channel count until it changes it, like normal ports
+		frontChannels = backChannels;
+	}
+};
+
+
 struct alignas(32) Port {
 	/** Voltage of the port. */
 	union {
@@ -33,6 +59,29 @@ struct alignas(32) Port {
 	*/
 	Light plugLights[3];
 
+	/** Bitmask of channels whose voltage changed with an event this frame.
+	Unstable API. Use hasEvent() and processEvents() instead.
+	*/
+	uint16_t events = 0;
+	/** Bitmask of output channels set with setEventVoltage() in the current process() call, sent to `events` after the module is stepped.
+	For inputs, events reported when a cable is connected, sent to `events` when the cable is next stepped.
+	*/
+	uint16_t pendingEvents = 0;
+	/** Whether the output reports every voltage change with setEventVoltage(), so inputs can wait for events instead of polling voltages.
+	Copied from the output to connected inputs.
+	Unstable API. Use setEventStream() and isEventStream() instead.
+	*/
+	bool eventStream = false;
+	/** Whether the port was configured with Module::configWideOutput() or configWideInput().
+	Unstable API. Use isWide() instead.
+	*/
+	bool wide = false;
+	/** For outputs, the bus owned by the port.
+	For inputs, the bus of the connected wide output, or NULL.
+	Unstable API. Use getWideChannels() and getWideVoltages() instead.
+	*/
+	WideBus* wideBus = NULL;
+
 	/** Sets the voltage of the given channel. */
 	void setVoltage(float voltage, int channel = 0) {
 		voltages[channel] = voltage;
@@ -98,6 +147,58 @@ struct alignas(32) Port {
 		return sum;
 	}
 
+	/** Sets the voltage of the given channel, and emits an event if it changed.
+	Use this for gate and trigger outputs marked with setEventStream(true), so that event-driven inputs don't need to poll and Schmitt-trigger the voltage every sample.
+	*/
+	void setEventVoltage(float voltage, int channel = 0) {
+		if (voltages[channel] != voltage) {
+			voltages[channel] = voltage;
+			pendingEvents |= 1 << channel;
+		}
+	}
+
+	/** Declares that all changes to this output's voltages are written with setEventVoltage().
+	Call this in your Module constructor.
+	*/
+	void setEventStream(bool eventStream) {
+		this->eventStream = eventStream;
+	}
+
+	/** Returns whether the input is connected to an event stream output.
+	If so, the voltage of a channel only changes on frames where hasEvent() is true.
+	*/
+	bool isEventStream() {
+		return eventStream;
+	}
+
+	/** Returns whether the voltage of the given channel changed with an event this frame. */
+	bool hasEvent(int channel = 0) {
+		return events & (1 << channel);
+	}
+
+	/** Returns whether any channel received an event this frame. */
+	bool hasEvents() {
+		return events != 0;
+	}
+
+	/** Calls `f(channel, voltage)` for each channel that received an event this frame.
+	Example:
+
+		if (inputs[CLOCK_INPUT].isEventStream()) {
+			inputs[CLOCK_INPUT].processEvents([&](int c, float v) {
+				if (v >= 1.f)
+					step(c);
+			});
+		}
+	*/
+	template <typename F>
+	void processEvents(F f) {
+		for (uint32_t e = events; e; e &= e - 1) {
+			int c = __builtin_ctz(e);
+			f(c, voltages[c]);
+		}
+	}
+
 	template <typename T>
 	T getVoltageSimd(int firstChannel) {
 		return T::load(&voltages[firstChannel]);
@@ -136,6 +237,7 @@ struct alignas(32) Port {
 		// Set higher channel voltages to 0
 		for (int c = channels; c < this->channels; c++) {
 			voltages[c] = 0.f;
+			pendingEvents |= 1 << c;
 		}
 		// Don't allow caller to set port as disconnected
 		if (channels == 0) {
@@ -168,6 +270,18 @@ struct alignas(32) Port {
 		return channels > 1;
 	}
 
+	/** Returns whether the port can carry a wide bus. */
+	bool isWide() {
+		return wide;
+	}
+
+	/** Returns the number of wide bus channels.
+	Inputs which are not connected to a wide output have 0 wide channels, but may still have normal channels.
+	*/
+	int getWideChannels() {
+		return wideBus ? wideBus->frontChannels : 0;
+	}
+
 	void process(float deltaTime);
 
 	/** Use getNormalVoltage() instead. */
@@ -177,9 +291,38 @@ struct alignas(32) Port {
 };
 
 
-struct Output : Port {};
+struct Output : Port {
+	/** Sets the number of wide bus channels, up to the maximum given to Module::configWideOutput().
+	The first PORT_MAX_CHANNELS channels are also sent as normal voltages, so wide outputs can be connected to any input.
+	*/
+	void setWideChannels(int channels) {
+		channels = std::max(0, std::min(channels, wideBus->maxChannels));
+		wideBus->backChannels = channels;
+		setChannels(std::min(channels, PORT_MAX_CHANNELS));
+	}
+
+	/** Returns the number of wide bus channels to write in this process() call. */
+	int getWideChannels() {
+		return wideBus ? wideBus->backChannels : 0;
+	}
 
-struct Input : Port {};
+	/** Returns the wide bus voltages to write in this process() call, aligned to 32 bytes.
+	The buffer alternates between frames, so write all getWideChannels() channels every time.
+	Normal voltages of a wide output are written by the engine, so don't use setVoltage() etc.
+	*/
+	float* getWideVoltages() {
+		return wideBus->back;
+	}
+};
+
+struct Input : Port {
+	/** Returns the wide bus voltages of the connected output, aligned to 32 bytes, or NULL if not connected to a wide output.
+	Do not write to this buffer.
+	*/
+	const float* getWideVoltages() {
+		return wideBus ? wideBus->front : NULL;
+	}
+};
 
 
 } // namespace engine
@@ -20,13 +20,19 @@ template <class TModule, class TModuleWidget>
 plugin::Model* createModel(const std::string& slug) {
 	struct TModel : plugin::Model {
 		engine::Module* createModule() override {
-			engine::Module* m = new TModule;
+			// Attribute the allocations of the constructor, including the Module itself, to the new Module
+			memory::Counter* memoryCounter = new memory::Counter;
+			engine::Module* m;
+			{
+				memory::Scope memoryScope(memoryCounter);
+				m = new TModule;
+			}
+			m->memoryCounter = memoryCounter;
 			m->model = this;
 			return m;
 		}
 		app::ModuleWidget* createModuleWidget() override {
-			TModule* m = new TModule;
-			m->engine::Module::model = this;
+			TModule* m = static_cast<TModule*>(createModule());
 			app::ModuleWidget* mw = new TModuleWidget(m);
 			mw->model = this;
 			return mw;
@@ -0,0 +1,49 @@
+#pragma once
+#include <common.hpp>
+#include <atomic>
+#include <cstdint>
+
+
+namespace rack {
+
+
+/** Heap allocation accounting
+On Linux and Mac, Rack replaces the global operator new and delete, which plugins share, so that allocations can be attributed to whatever is active on the current thread, e.g. the Module being constructed or processed.
+Each block remembers its Counter, so freeing it later on any thread subtracts it from the same Counter.
+On Windows, each plugin DLL has its own allocation functions, so nothing is attributed.
+Blocks allocated with malloc() directly are not attributed.
+*/
+namespace memory {
+
+
+/** Bytes of the blocks allocated while a Scope with this Counter was active, which haven't been freed yet. */
+struct Counter {
+	std::atomic<int64_t> bytes{0};
+	/** The owner's reference, plus one for each block that hasn't been freed yet */
+	std::atomic<int64_t> refs{1};
+};
+
+
+/** Releases the owner's reference to a Counter.
+The Counter is deleted once all blocks attributed to it are also freed.
+*/
+void release(Counter* counter);
+
+
+/** Attributes allocations on the current thread to a Counter for the lifetime of the Scope.
+Scopes can be nested, and the innermost Counter receives the bytes.
+A NULL Counter stops attribution.
+*/
+struct Scope {
+	Counter* prevCounter;
+	Scope(Counter* counter);
+	~Scope();
+};
+
+
+/** Returns the Counter of the innermost Scope on the current thread, or NULL. */
+Counter* getCounter();
+
+
+} // namespace memory
+} // namespace rack
@@ -7,6 +7,9 @@ namespace rack {
 
 
 struct PatchManager {
+	struct Internal;
+	Internal* internal;
+
 	/** The currently loaded patch file path */
 	std::string path;
 	/** Enables certain compatibility behavior based on the value */
@@ -29,6 +32,24 @@ struct PatchManager {
 	void revertDialog();
 	/** Disconnects all cables */
 	void disconnectDialog();
+	/** Starts loading a patch in the background while the current patch keeps running.
+	The file is parsed on a worker thread, then its modules are constructed off-screen by step().
+	Modules' dataFromJson() is not called until loadPreloaded(), so they don't open devices or map params while the current patch runs.
+	Replaces any patch which was already preloaded.
+	*/
+	void preload(std::string path);
+	void preloadDialog();
+	/** Returns whether a preloaded patch is ready to be swapped in. */
+	bool isPreloaded();
+	/** Returns the path of the patch being preloaded, or "" if none. */
+	std::string getPreloadPath();
+	/** Replaces the current patch with the preloaded patch.
+	The old patch is removed first, then the new modules' data is loaded and they are added with their cables at a single engine block boundary.
+	Returns false if no preloaded patch is ready.
+	*/
+	bool loadPreloaded();
+	/** Advances background loading. Called every frame by the Scene. */
+	void step();
 
 	json_t* toJson();
 	void fromJson(json_t* rootJ);
@@ -83,6 +83,7 @@
 
 #include <dsp/common.hpp>
 #include <dsp/digital.hpp>
+#include <dsp/envelope.hpp>
 #include <dsp/fft.hpp>
 #include <dsp/filter.hpp>
 #include <dsp/fir.hpp>
@@ -94,6 +95,7 @@
 #include <dsp/vumeter.hpp>
 #include <dsp/window.hpp>
 #include <dsp/approx.hpp>
+#include <dsp/waveshaper.hpp>
 
 #include <simd/vector.hpp>
 #include <simd/functions.hpp>
@@ -24,6 +24,15 @@ float uniform();
 /** Returns a normal random number with mean 0 and standard deviation 1 */
 float normal();
 
+/** Fills an RNG state from a 64-bit seed, for use with setState().
+The same seed always produces the same sequence.
+*/
+void seedState(uint64_t state[2], uint64_t seed);
+/** Copies the thread-local RNG state to `state`. */
+void getState(uint64_t state[2]);
+/** Replaces the thread-local RNG state, e.g. to switch between independent random streams. */
+void setState(const uint64_t state[2]);
+
 
 } // namespace random
 } // namespace rack
@@ -29,8 +29,28 @@ extern float cableOpacity;
 extern float cableTension;
 extern bool allowCursorLock;
 extern bool realTime;
+/** Sample rate of the engine, or 0 to follow the sample rate of the primary audio device. */
 extern float sampleRate;
 extern int threadCount;
+/** Number of frames the engine steps between acquiring its lock.
+When no module blocks the engine, this is also the interval at which the engine is paced against the system clock.
+*/
+extern int engineBlockSize;
+/** Whether the engine assigns clusters of connected modules to fixed threads rather than scheduling them dynamically. */
+extern bool stickyThreads;
+/** Whether the engine degrades and suspends low-priority modules when it is close to missing its deadline. */
+extern bool loadShedding;
+/** Whether the engine delays cables on paths with less module latency than parallel paths, so that the paths arrive at modules aligned. */
+extern bool delayCompensation;
+/** Whether the engine checks module outputs for NaN, infinite, and denormal voltages and marks the modules that produce them. */
+extern bool checkVoltages;
+/** Whether cables replace invalid voltages from marked modules with 0V. */
+extern bool sanitizeVoltages;
+/** Whether the engine produces identical output for identical patches, regardless of thread count and timing.
+Modules draw random numbers from their own streams seeded by `randomSeed`, expander-linked modules are stepped in a fixed order on one thread, and load shedding is disabled.
+*/
+extern bool deterministic;
+extern uint64_t randomSeed;
 extern bool paramTooltip;
 extern bool cpuMeter;
 extern bool lockModules;
@@ -0,0 +1,31 @@
+#pragma once
+#include <common.hpp>
+
+
+namespace rack {
+
+
+/** Profiler for the launch of Rack
+Times each initialization phase, plugin library, and asset loaded until finish() is called.
+Afterwards, Timers do nothing, so the same code paths can run later without recording.
+*/
+namespace startup {
+
+
+/** Times a step of startup from construction to destruction.
+`category` groups similar steps in the report, e.g. "phase", "dlopen", or "svg".
+Timers can be nested.
+*/
+struct Timer {
+	int index;
+	Timer(const std::string& category, const std::string& name);
+	~Timer();
+};
+
+
+/** Stops recording, writes the report to `asset::startupReportPath`, and logs a summary. */
+void finish();
+
+
+} // namespace startup
+} // namespace rack
@@ -34,6 +34,12 @@ void setThreadName(const std::string& name);
 void setThreadRealTime(bool realTime);
 /** Returns the number of seconds the current thread has been active. */
 double getThreadTime();
+/** Returns the time in seconds of a monotonic clock, which is not affected by changes to the system time. */
+double getTime();
+/** Sleeps until getTime() reaches the given time.
+Uses an absolute deadline where possible, so repeated calls with evenly spaced times do not accumulate drift.
+*/
+void sleepUntil(double time);
 /** Returns the caller's human-readable stack trace with "\n"-separated lines. */
 std::string getStackTrace();
 /** Opens a URL, also happens to work with PDFs and folders.
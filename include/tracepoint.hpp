@@ -0,0 +1,34 @@
+#pragma once
+
+
+/** Statically-defined tracepoints (USDT probes) for attaching perf, bpftrace, or SystemTap to a running Rack without rebuilding.
+Each probe compiles to a single `nop` instruction plus a note in the ELF binary, so it costs nearly nothing unless a tracer is attached.
+Probes are in the `rack` provider. For example, to list them:
+
+	bpftrace -l 'usdt:./Rack:rack:*'
+
+and to print a histogram of block durations in nanoseconds:
+
+	bpftrace -e 'usdt:./Rack:rack:block_begin { @t = nsecs; } usdt:./Rack:rack:block_end /@t/ { @ns = hist(nsecs - @t); }'
+
+Tracepoints are only available on Linux with <sys/sdt.h> (from systemtap-sdt-dev or systemtap-sdt-devel) installed at compile time.
+Otherwise, or if RACK_NO_TRACEPOINTS is defined, the macros expand to nothing.
+*/
+#if defined ARCH_LIN && !defined RACK_NO_TRACEPOINTS && defined __has_include
+	#if __has_include(<sys/sdt.h>)
+		#include <sys/sdt.h>
+		#define RACK_TRACEPOINTS
+	#endif
+#endif
+
+#if defined RACK_TRACEPOINTS
+	#define TRACEPOINT(name) DTRACE_PROBE(rack, name)
+	#define TRACEPOINT1(name, a) DTRACE_PROBE1(rack, name, a)
+	#define TRACEPOINT2(name, a, b) DTRACE_PROBE2(rack, name, a, b)
+	#define TRACEPOINT3(name, a, b, c) DTRACE_PROBE3(rack, name, a, b, c)
+#else
+	#define TRACEPOINT(name) do {} while (0)
+	#define TRACEPOINT1(name, a) do {} while (0)
+	#define TRACEPOINT2(name, a, b) do {} while (0)
+	#define TRACEPOINT3(name, a, b, c) do {} while (0)
+#endif
@@ -39,27 +39,46 @@ ifdef ARCH_WIN
 	RACK_USER_DIR ?= "$(USERPROFILE)"/Documents/Rack
 endif
 
+# Instruction set variants to build alongside the baseline library, e.g.
+#
+#	ISA_VARIANTS += avx2 avx512
+#
+# Each variant is built as plugin-<isa>.so (or .dylib/.dll), and Rack loads the best one supported by the CPU.
+ISA_TARGETS := $(foreach isa, $(ISA_VARIANTS), $(basename $(TARGET))-$(isa)$(suffix $(TARGET)))
+ifdef ISA
+	# Building a single variant with a recursive make
+	TARGET := $(basename $(TARGET))-$(ISA)$(suffix $(TARGET))
+	BUILD_DIR := build-$(ISA)
+endif
+
 
 DEP_FLAGS += -fPIC
 include $(RACK_DIR)/dep.mk
 
 
 all: $(TARGET)
+ifndef ISA
+all: $(ISA_VARIANTS:%=isa-%)
+endif
+
+# Build dependencies before the variants, so parallel recursive makes don't each build them
+$(ISA_VARIANTS:%=isa-%): isa-%: $(DEPS)
+	$(MAKE) ISA=$*
 
 include $(RACK_DIR)/compile.mk
 
 clean:
-	rm -rfv build $(TARGET) dist
+	rm -rfv build $(ISA_VARIANTS:%=build-%) $(TARGET) $(ISA_TARGETS) dist
 
 dist: all
 	rm -rf dist
 	mkdir -p dist/"$(SLUG)"
-	@# Strip and copy plugin binary
-	cp $(TARGET) dist/"$(SLUG)"/
+	@# Strip and copy plugin binaries
+	cp $(TARGET) $(ISA_TARGETS) dist/"$(SLUG)"/
 ifdef ARCH_MAC
-	$(STRIP) -S dist/"$(SLUG)"/$(TARGET)
+	$(STRIP) -S $(addprefix dist/"$(SLUG)"/, $(TARGET) $(ISA_TARGETS))
 else
-	$(STRIP) -s dist/"$(SLUG)"/$(TARGET)
+	$(STRIP) -s $(addprefix dist/"$(SLUG)"/, $(TARGET) $(ISA_TARGETS))
 endif
 	@# Copy distributables
 ifdef ARCH_MAC
@@ -73,5 +92,5 @@ endif
 install: dist
 	cp dist/"$(SLUG)"-"$(VERSION)"-$(ARCH).zip $(RACK_USER_DIR)/plugins-v1/
 
-.PHONY: clean dist
+.PHONY: clean dist $(ISA_VARIANTS:%=isa-%)
 .DEFAULT_GOAL := all
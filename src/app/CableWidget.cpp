@@ -235,7 +235,7 @@ void CableWidget::draw(const DrawArgs& args) {
 	float thickness = 5;
 
 	if (isComplete()) {
-		engine::Output* output = &cable->outputModule->outputs[cable->outputId];
+		engine::Output* output = &cable->outputModule->getOutput(cable->outputId);
 		// Draw opaque if mouse is hovering over a connected port
 		if (output->channels > 1) {
 			// Increase thickness if output port is polyphonic
@@ -88,6 +88,18 @@ struct OpenItem : ui::MenuItem {
 	}
 };
 
+struct PreloadItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		APP->patch->preloadDialog();
+	}
+};
+
+struct LoadPreloadedItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		APP->patch->loadPreloaded();
+	}
+};
+
 struct SaveItem : ui::MenuItem {
 	void onAction(const event::Action& e) override {
 		APP->patch->saveDialog();
@@ -134,6 +146,18 @@ struct FileButton : MenuButton {
 		openItem->rightText = RACK_MOD_CTRL_NAME "+O";
 		menu->addChild(openItem);
 
+		PreloadItem* preloadItem = new PreloadItem;
+		preloadItem->text = "Preload next";
+		menu->addChild(preloadItem);
+
+		std::string preloadPath = APP->patch->getPreloadPath();
+		if (!preloadPath.empty()) {
+			LoadPreloadedItem* loadPreloadedItem = new LoadPreloadedItem;
+			loadPreloadedItem->text = "Switch to " + string::filename(preloadPath);
+			loadPreloadedItem->disabled = !APP->patch->isPreloaded();
+			menu->addChild(loadPreloadedItem);
+		}
+
 		SaveItem* saveItem = new SaveItem;
 		saveItem->text = "Save";
 		saveItem->rightText = RACK_MOD_CTRL_NAME "+S";
@@ -413,6 +437,36 @@ struct CpuMeterItem : ui::MenuItem {
 	}
 };
 
+struct LoadSheddingItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		settings::loadShedding ^= true;
+	}
+};
+
+struct DelayCompensationItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		settings::delayCompensation ^= true;
+	}
+};
+
+struct CheckVoltagesItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		settings::checkVoltages ^= true;
+	}
+};
+
+struct SanitizeVoltagesItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		settings::sanitizeVoltages ^= true;
+	}
+};
+
+struct DeterministicItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		settings::deterministic ^= true;
+	}
+};
+
 struct EnginePauseItem : ui::MenuItem {
 	void onAction(const event::Action& e) override {
 		APP->engine->setPaused(!APP->engine->isPaused());
@@ -436,6 +490,14 @@ struct SampleRateItem : ui::MenuItem {
 		enginePauseItem->rightText = CHECKMARK(APP->engine->isPaused());
 		menu->addChild(enginePauseItem);
 
+		SampleRateValueItem* autoItem = new SampleRateValueItem;
+		autoItem->sampleRate = 0.f;
+		autoItem->text = "Auto (audio device)";
+		if (settings::sampleRate <= 0.f)
+			autoItem->rightText = string::f("%g kHz ", APP->engine->getSampleRate() / 1000.0);
+		autoItem->rightText += CHECKMARK(settings::sampleRate <= 0.f);
+		menu->addChild(autoItem);
+
 		for (int i = 0; i <= 4; i++) {
 			for (int j = 0; j < 2; j++) {
 				int oversample = 1 << i;
@@ -456,12 +518,43 @@ struct SampleRateItem : ui::MenuItem {
 	}
 };
 
+struct EngineBlockSizeValueItem : ui::MenuItem {
+	int engineBlockSize;
+	void onAction(const event::Action& e) override {
+		settings::engineBlockSize = engineBlockSize;
+	}
+};
+
+struct EngineBlockSizeItem : ui::MenuItem {
+	ui::Menu* createChildMenu() override {
+		ui::Menu* menu = new ui::Menu;
+		for (int i = 4; i <= 10; i++) {
+			int engineBlockSize = 1 << i;
+			EngineBlockSizeValueItem* item = new EngineBlockSizeValueItem;
+			item->engineBlockSize = engineBlockSize;
+			item->text = string::f("%d", engineBlockSize);
+			if (engineBlockSize == 128)
+				item->text += " (default)";
+			item->rightText = string::f("%.1f ms ", engineBlockSize / APP->engine->getSampleRate() * 1000.f);
+			item->rightText += CHECKMARK(settings::engineBlockSize == engineBlockSize);
+			menu->addChild(item);
+		}
+		return menu;
+	}
+};
+
 struct RealTimeItem : ui::MenuItem {
 	void onAction(const event::Action& e) override {
 		settings::realTime ^= true;
 	}
 };
 
+struct StickyThreadsItem : ui::MenuItem {
+	void onAction(const event::Action& e) override {
+		settings::stickyThreads ^= true;
+	}
+};
+
 struct ThreadCountValueItem : ui::MenuItem {
 	int threadCount;
 	void setThreadCount(int threadCount) {
@@ -487,6 +580,11 @@ struct ThreadCountItem : ui::MenuItem {
 		realTimeItem->rightText = CHECKMARK(settings::realTime);
 		menu->addChild(realTimeItem);
 
+		StickyThreadsItem* stickyThreadsItem = new StickyThreadsItem;
+		stickyThreadsItem->text = "Sticky scheduling";
+		stickyThreadsItem->rightText = CHECKMARK(settings::stickyThreads);
+		menu->addChild(stickyThreadsItem);
+
 		int coreCount = system::getLogicalCoreCount();
 		for (int i = 1; i <= coreCount; i++) {
 			ThreadCountValueItem* item = new ThreadCountValueItem;
@@ -509,11 +607,43 @@ struct EngineButton : MenuButton {
 		cpuMeterItem->rightText += CHECKMARK(settings::cpuMeter);
 		menu->addChild(cpuMeterItem);
 
+		LoadSheddingItem* loadSheddingItem = new LoadSheddingItem;
+		loadSheddingItem->text = "Load shedding";
+		loadSheddingItem->rightText = CHECKMARK(settings::loadShedding);
+		menu->addChild(loadSheddingItem);
+
+		DelayCompensationItem* delayCompensationItem = new DelayCompensationItem;
+		delayCompensationItem->text = "Delay compensation";
+		delayCompensationItem->rightText = CHECKMARK(settings::delayCompensation);
+		menu->addChild(delayCompensationItem);
+
+		DeterministicItem* deterministicItem = new DeterministicItem;
+		deterministicItem->text = "Deterministic";
+		deterministicItem->rightText = CHECKMARK(settings::deterministic);
+		menu->addChild(deterministicItem);
+
+		CheckVoltagesItem* checkVoltagesItem = new CheckVoltagesItem;
+		checkVoltagesItem->text = "Detect NaN/Inf voltages";
+		checkVoltagesItem->rightText = CHECKMARK(settings::checkVoltages);
+		menu->addChild(checkVoltagesItem);
+
+		if (settings::checkVoltages) {
+			SanitizeVoltagesItem* sanitizeVoltagesItem = new SanitizeVoltagesItem;
+			sanitizeVoltagesItem->text = "Replace NaN/Inf voltages with 0V";
+			sanitizeVoltagesItem->rightText = CHECKMARK(settings::sanitizeVoltages);
+			menu->addChild(sanitizeVoltagesItem);
+		}
+
 		SampleRateItem* sampleRateItem = new SampleRateItem;
 		sampleRateItem->text = "Sample rate";
 		sampleRateItem->rightText = RIGHT_ARROW;
 		menu->addChild(sampleRateItem);
 
+		EngineBlockSizeItem* engineBlockSizeItem = new EngineBlockSizeItem;
+		engineBlockSizeItem->text = "Block size";
+		engineBlockSizeItem->rightText = RIGHT_ARROW;
+		menu->addChild(engineBlockSizeItem);
+
 		ThreadCountItem* threadCount = new ThreadCountItem;
 		threadCount->text = "Threads";
 		threadCount->rightText = RIGHT_ARROW;
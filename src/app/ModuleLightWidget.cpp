@@ -9,10 +9,10 @@ void ModuleLightWidget::step() {
 	std::vector<float> brightnesses(baseColors.size());
 
 	if (module) {
-		assert(module->lights.size() >= firstLightId + baseColors.size());
+		assert(module->getNumLights() >= firstLightId + (int) baseColors.size());
 
 		for (size_t i = 0; i < baseColors.size(); i++) {
-			float b = module->lights[firstLightId + i].getBrightness();
+			float b = module->getLight(firstLightId + i).getBrightness();
 			if (!std::isfinite(b))
 				b = 0.f;
 			b = math::clamp(b, 0.f, 1.f);
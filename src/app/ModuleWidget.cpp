@@ -253,7 +253,7 @@ ModuleWidget::~ModuleWidget() {
 void ModuleWidget::draw(const DrawArgs& args) {
 	nvgScissor(args.vg, RECT_ARGS(args.clipBox));
 
-	if (module && module->bypass) {
+	if (module && (module->bypass || module->suspended)) {
 		nvgGlobalAlpha(args.vg, 0.33);
 	}
 
@@ -263,15 +263,16 @@ void ModuleWidget::draw(const DrawArgs& args) {
 	if (module && settings::cpuMeter && !module->bypass) {
 		nvgBeginPath(args.vg);
 		nvgRect(args.vg,
-		        0, box.size.y - 35,
-		        65, 35);
+		        0, box.size.y - 50,
+		        65, 50);
 		nvgFillColor(args.vg, nvgRGBAf(0, 0, 0, 0.75));
 		nvgFill(args.vg);
 
 		float percent = module->cpuTime * APP->engine->getSampleRate() * 100;
 		float microseconds = module->cpuTime * 1e6f;
-		std::string cpuText = string::f("%.1f%%\n%.2f μs", percent, microseconds);
-		bndLabel(args.vg, 2.0, box.size.y - 34.0, INFINITY, INFINITY, -1, cpuText.c_str());
+		float megabytes = module->getMemoryUsage() / 1e6f;
+		std::string cpuText = string::f("%.1f%%\n%.2f μs\n%.1f MB", percent, microseconds, megabytes);
+		bndLabel(args.vg, 2.0, box.size.y - 49.0, INFINITY, INFINITY, -1, cpuText.c_str());
 
 		float p = math::clamp(module->cpuTime / APP->engine->getSampleTime(), 0.f, 1.f);
 		nvgBeginPath(args.vg);
@@ -282,6 +283,21 @@ void ModuleWidget::draw(const DrawArgs& args) {
 		nvgFill(args.vg);
 	}
 
+	// Invalid voltage marker
+	if (module && settings::checkVoltages && module->faultOutputId >= 0) {
+		for (PortWidget* pw : outputs) {
+			if (pw->portId != module->faultOutputId)
+				continue;
+			math::Vec c = pw->box.getCenter();
+			float r = std::fmax(pw->box.size.x, pw->box.size.y) / 2 + 2;
+			nvgBeginPath(args.vg);
+			nvgCircle(args.vg, c.x, c.y, r);
+			nvgStrokeWidth(args.vg, 2.0);
+			nvgStrokeColor(args.vg, nvgRGBAf(1, 0, 0, 1.0));
+			nvgStroke(args.vg);
+		}
+	}
+
 	// if (module) {
 	// 	nvgBeginPath(args.vg);
 	// 	nvgRect(args.vg, 0, 0, 20, 20);
@@ -40,9 +40,9 @@ void PortWidget::step() {
 	std::vector<float> values(3);
 	for (int i = 0; i < 3; i++) {
 		if (type == OUTPUT)
-			values[i] = module->outputs[portId].plugLights[i].getBrightness();
+			values[i] = module->getOutput(portId).plugLights[i].getBrightness();
 		else
-			values[i] = module->inputs[portId].plugLights[i].getBrightness();
+			values[i] = module->getInput(portId).plugLights[i].getBrightness();
 	}
 	plugLight->setBrightnesses(values);
 
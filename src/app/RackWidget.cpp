@@ -9,6 +9,8 @@
 #include <app.hpp>
 #include <asset.hpp>
 #include <patch.hpp>
+#include <tracepoint.hpp>
+#include <startup.hpp>
 #include <osdialog.h>
 #include <map>
 #include <algorithm>
@@ -39,6 +41,7 @@ static ModuleWidget* moduleFromJson(json_t* moduleJ) {
 		return NULL;
 
 	// Create ModuleWidget
+	startup::Timer timer("module", pluginSlug + "/" + modelSlug);
 	ModuleWidget* moduleWidget = model->createModuleWidget();
 	assert(moduleWidget);
 	moduleWidget->fromJson(moduleJ);
@@ -224,46 +227,65 @@ json_t* RackWidget::toJson() {
 }
 
 void RackWidget::fromJson(json_t* rootJ) {
-	// modules
 	json_t* modulesJ = json_object_get(rootJ, "modules");
 	if (!modulesJ)
 		return;
+	for (ModuleWidget* moduleWidget : modulesFromJson(rootJ)) {
+		addModule(moduleWidget);
+	}
+	TRACEPOINT1(patch_modules_end, json_array_size(modulesJ));
+	cablesFromJson(rootJ);
+}
+
+std::vector<ModuleWidget*> RackWidget::modulesFromJson(json_t* rootJ) {
+	std::vector<ModuleWidget*> moduleWidgets;
+	// modules
+	json_t* modulesJ = json_object_get(rootJ, "modules");
+	if (!modulesJ)
+		return moduleWidgets;
 	size_t moduleIndex;
 	json_t* moduleJ;
 	json_array_foreach(modulesJ, moduleIndex, moduleJ) {
-		ModuleWidget* moduleWidget = moduleFromJson(moduleJ);
+		ModuleWidget* moduleWidget = moduleWidgetFromJson(moduleJ, moduleIndex);
+		if (moduleWidget)
+			moduleWidgets.push_back(moduleWidget);
+	}
+	return moduleWidgets;
+}
 
-		if (moduleWidget) {
-			// Before 1.0, the module ID was the index in the "modules" array
-			if (APP->patch->isLegacy(2)) {
-				moduleWidget->module->id = moduleIndex;
-			}
+ModuleWidget* RackWidget::moduleWidgetFromJson(json_t* moduleJ, size_t moduleIndex) {
+	ModuleWidget* moduleWidget = moduleFromJson(moduleJ);
+	if (!moduleWidget) {
+		json_t* pluginSlugJ = json_object_get(moduleJ, "plugin");
+		json_t* modelSlugJ = json_object_get(moduleJ, "model");
+		std::string pluginSlug = json_string_value(pluginSlugJ);
+		std::string modelSlug = json_string_value(modelSlugJ);
+		APP->patch->warningLog += string::f("Could not find module \"%s\" of plugin \"%s\"\n", modelSlug.c_str(), pluginSlug.c_str());
+		return NULL;
+	}
 
-			// pos
-			json_t* posJ = json_object_get(moduleJ, "pos");
-			double x, y;
-			json_unpack(posJ, "[F, F]", &x, &y);
-			math::Vec pos = math::Vec(x, y);
-			if (APP->patch->isLegacy(1)) {
-				// Before 0.6, positions were in pixel units
-				moduleWidget->box.pos = pos;
-			}
-			else {
-				moduleWidget->box.pos = pos.mult(RACK_GRID_SIZE);
-			}
-			moduleWidget->box.pos = moduleWidget->box.pos.plus(RACK_OFFSET);
+	// Before 1.0, the module ID was the index in the "modules" array
+	if (APP->patch->isLegacy(2)) {
+		moduleWidget->module->id = moduleIndex;
+	}
 
-			addModule(moduleWidget);
-		}
-		else {
-			json_t* pluginSlugJ = json_object_get(moduleJ, "plugin");
-			json_t* modelSlugJ = json_object_get(moduleJ, "model");
-			std::string pluginSlug = json_string_value(pluginSlugJ);
-			std::string modelSlug = json_string_value(modelSlugJ);
-			APP->patch->warningLog += string::f("Could not find module \"%s\" of plugin \"%s\"\n", modelSlug.c_str(), pluginSlug.c_str());
-		}
+	// pos
+	json_t* posJ = json_object_get(moduleJ, "pos");
+	double x, y;
+	json_unpack(posJ, "[F, F]", &x, &y);
+	math::Vec pos = math::Vec(x, y);
+	if (APP->patch->isLegacy(1)) {
+		// Before 0.6, positions were in pixel units
+		moduleWidget->box.pos = pos;
+	}
+	else {
+		moduleWidget->box.pos = pos.mult(RACK_GRID_SIZE);
 	}
+	moduleWidget->box.pos = moduleWidget->box.pos.plus(RACK_OFFSET);
+	return moduleWidget;
+}
 
+void RackWidget::cablesFromJson(json_t* rootJ) {
 	// cables
 	json_t* cablesJ = json_object_get(rootJ, "cables");
 	// Before 1.0, cables were called wires
@@ -282,6 +304,7 @@ void RackWidget::fromJson(json_t* rootJ) {
 		}
 		addCable(cw);
 	}
+	TRACEPOINT1(patch_cables_end, json_array_size(cablesJ));
 }
 
 void RackWidget::pastePresetClipboardAction() {
@@ -6,6 +6,7 @@
 #include <history.hpp>
 #include <settings.hpp>
 #include <patch.hpp>
+#include <engine/Engine.hpp>
 #include <asset.hpp>
 #include <osdialog.h>
 #include <thread>
@@ -65,6 +66,9 @@ void Scene::step() {
 		}
 	}
 
+	APP->patch->step();
+	APP->engine->updateLatencyCompensation();
+
 	Widget::step();
 }
 
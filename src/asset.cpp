@@ -123,6 +123,7 @@ void init() {
 		settingsPath = userDir + "/settings.json";
 		autosavePath = userDir + "/autosave.vcv";
 		templatePath = userDir + "/template.vcv";
+		startupReportPath = userDir + "/startup.json";
 	}
 	else {
 		logPath = userDir + "/log.txt";
@@ -130,6 +131,7 @@ void init() {
 		settingsPath = userDir + "/settings-v" + app::ABI_VERSION + ".json";
 		autosavePath = userDir + "/autosave-v" + app::ABI_VERSION + ".vcv";
 		templatePath = userDir + "/template-v" + app::ABI_VERSION + ".vcv";
+		startupReportPath = userDir + "/startup.json";
 	}
 }
 
@@ -158,6 +160,7 @@ std::string pluginsPath;
 std::string settingsPath;
 std::string autosavePath;
 std::string templatePath;
+std::string startupReportPath;
 std::string bundlePath;
 
 
@@ -3,6 +3,7 @@
 #include <math.hpp>
 #include <bridge.hpp>
 #include <system.hpp>
+#include <tracepoint.hpp>
 
 
 namespace rack {
@@ -213,6 +214,7 @@ static int rtCallback(void* outputBuffer, void* inputBuffer, unsigned int nFrame
 		system::setThreadName("Audio");
 		// system::setThreadRealTime();
 	}
+	TRACEPOINT1(audio_callback, nFrames);
 	port->processStream((const float*) inputBuffer, (float*) outputBuffer, nFrames);
 	return 0;
 }
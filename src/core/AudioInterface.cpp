@@ -119,10 +119,29 @@ struct AudioInterface : Module {
 	AudioInterface() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
 		port.maxChannels = std::max(AUDIO_OUTPUTS, AUDIO_INPUTS);
+		// The engine is clocked by the audio device, so never shed this module.
+		priority = PRIORITY_CRITICAL;
 		onSampleRateChange();
 	}
 
 	void process(const ProcessArgs& args) override {
+		// The first interface with an open device clocks the engine, so the engine can follow its sample rate and the SRCs pass frames through.
+		// Other interfaces resample to the engine rate.
+		bool open = (port.numOutputs > 0 || port.numInputs > 0);
+		Module* primaryModule = APP->engine->getPrimaryModule();
+		if (open && !primaryModule && APP->engine->setPrimaryModule(this)) {
+			primaryModule = this;
+			lastSampleRate = 0;
+		}
+		else if (!open && primaryModule == this) {
+			APP->engine->setPrimaryModule(NULL);
+			primaryModule = NULL;
+		}
+		if (primaryModule == this && port.sampleRate != lastSampleRate) {
+			APP->engine->setSuggestedSampleRate(port.sampleRate);
+			lastSampleRate = port.sampleRate;
+		}
+
 		// Update SRC states
 		inputSrc.setRates(port.sampleRate, args.sampleRate);
 		outputSrc.setRates(args.sampleRate, port.sampleRate);
@@ -138,6 +157,8 @@ struct AudioInterface : Module {
 			auto cond = [&] {
 				return (!port.inputBuffer.empty());
 			};
+			if (!cond())
+				APP->engine->yieldWorkers();
 			auto timeout = std::chrono::milliseconds(200);
 			if (port.engineCv.wait_for(lock, timeout, cond)) {
 				// Convert inputs
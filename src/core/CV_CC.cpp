@@ -48,7 +48,7 @@ struct CV_CC : Module {
 	};
 
 	CCMidiOutput midiOutput;
-	float rateLimiterPhase = 0.f;
+	ScanClock scanClock{100.f};
 	int learningId = -1;
 	int learnedCcs[16] = {};
 
@@ -67,14 +67,8 @@ struct CV_CC : Module {
 	}
 
 	void process(const ProcessArgs& args) override {
-		const float rateLimiterPeriod = 0.010f;
-		rateLimiterPhase += args.sampleTime / rateLimiterPeriod;
-		if (rateLimiterPhase >= 1.f) {
-			rateLimiterPhase -= 1.f;
-		}
-		else {
+		if (!scanClock.process(args.sampleTime))
 			return;
-		}
 
 		for (int i = 0; i < 16; i++) {
 			int value = (int) std::round(inputs[CC_INPUTS + i].getVoltage() / 10.f * 127);
@@ -93,6 +87,7 @@ struct CV_CC : Module {
 		json_object_set_new(rootJ, "ccs", ccsJ);
 
 		json_object_set_new(rootJ, "midi", midiOutput.toJson());
+		json_object_set_new(rootJ, "scanRate", json_real(scanClock.rate));
 		return rootJ;
 	}
 
@@ -109,6 +104,10 @@ struct CV_CC : Module {
 		json_t* midiJ = json_object_get(rootJ, "midi");
 		if (midiJ)
 			midiOutput.fromJson(midiJ);
+
+		json_t* scanRateJ = json_object_get(rootJ, "scanRate");
+		if (scanRateJ)
+			scanClock.rate = math::clamp(json_number_value(scanRateJ), 1.f, 4000.f);
 	}
 };
 
@@ -147,6 +146,15 @@ struct CV_CCWidget : ModuleWidget {
 		midiWidget->setModule(module);
 		addChild(midiWidget);
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		CV_CC* module = dynamic_cast<CV_CC*>(this->module);
+
+		menu->addChild(new MenuEntry);
+		ScanRateItem<CV_CC>* scanRateItem = createMenuItem<ScanRateItem<CV_CC>>("Scan rate", RIGHT_ARROW);
+		scanRateItem->module = module;
+		menu->addChild(scanRateItem);
+	}
 };
 
 
@@ -75,6 +75,10 @@ struct CV_Gate : Module {
 	};
 
 	GateMidiOutput midiOutput;
+	ScanClock scanClock{1000.f};
+	GateScanner gateScanner;
+	/** Highest voltage of each input since the last scan, so short gates keep their velocity */
+	float peaks[16];
 	bool velocityMode = false;
 	int learningId = -1;
 	uint8_t learnedNotes[16] = {};
@@ -93,23 +97,47 @@ struct CV_Gate : Module {
 		learningId = -1;
 		midiOutput.reset();
 		midiOutput.midi::Output::reset();
+		gateScanner.reset();
+		for (int i = 0; i < 16; i++) {
+			peaks[i] = 0.f;
+		}
 	}
 
 	void process(const ProcessArgs& args) override {
+		// In velocity mode, the gate is on when the velocity rounds to at least 1.
+		const float threshold = velocityMode ? (0.5f / 127 * 10.f) : 1.f;
+		uint16_t gates = gateScanner.gates;
+		for (int i = 0; i < 16; i++) {
+			// Gates from event streams can only change when an event arrives
+			if (inputs[GATE_INPUTS + i].isEventStream() && !inputs[GATE_INPUTS + i].hasEvent())
+				continue;
+			float v = inputs[GATE_INPUTS + i].getVoltage();
+			peaks[i] = std::fmax(peaks[i], v);
+			if (v >= threshold)
+				gates |= 1 << i;
+			else
+				gates &= ~(1 << i);
+		}
+		gateScanner.process(gates);
+
+		if (!scanClock.process(args.sampleTime))
+			return;
+
 		for (int i = 0; i < 16; i++) {
 			int note = learnedNotes[i];
+			int vel = 100;
 			if (velocityMode) {
-				int vel = (int) std::round(inputs[GATE_INPUTS + i].getVoltage() / 10.f * 127);
-				vel = clamp(vel, 0, 127);
-				midiOutput.setVelocity(vel, note);
-				midiOutput.setGate(vel > 0, note);
+				vel = (int) std::round(peaks[i] / 10.f * 127);
+				vel = clamp(vel, 1, 127);
 			}
-			else {
-				bool gate = inputs[GATE_INPUTS + i].getVoltage() >= 1.f;
-				midiOutput.setVelocity(100, note);
+			gateScanner.scan(i, [&](bool gate) {
+				if (gate)
+					midiOutput.setVelocity(vel, note);
 				midiOutput.setGate(gate, note);
-			}
+			});
+			peaks[i] = inputs[GATE_INPUTS + i].getVoltage();
 		}
+		gateScanner.clearEdges();
 	}
 
 	json_t* dataToJson() override {
@@ -125,6 +153,7 @@ struct CV_Gate : Module {
 		json_object_set_new(rootJ, "velocity", json_boolean(velocityMode));
 
 		json_object_set_new(rootJ, "midi", midiOutput.toJson());
+		json_object_set_new(rootJ, "scanRate", json_real(scanClock.rate));
 		return rootJ;
 	}
 
@@ -145,6 +174,10 @@ struct CV_Gate : Module {
 		json_t* midiJ = json_object_get(rootJ, "midi");
 		if (midiJ)
 			midiOutput.fromJson(midiJ);
+
+		json_t* scanRateJ = json_object_get(rootJ, "scanRate");
+		if (scanRateJ)
+			scanClock.rate = math::clamp(json_number_value(scanRateJ), 1.f, 4000.f);
 	}
 };
 
@@ -208,6 +241,10 @@ struct CV_GateWidget : ModuleWidget {
 		velocityItem->module = module;
 		menu->addChild(velocityItem);
 
+		ScanRateItem<CV_Gate>* scanRateItem = createMenuItem<ScanRateItem<CV_Gate>>("Scan rate", RIGHT_ARROW);
+		scanRateItem->module = module;
+		menu->addChild(scanRateItem);
+
 		CV_GatePanicItem* panicItem = new CV_GatePanicItem;
 		panicItem->text = "Panic";
 		panicItem->module = module;
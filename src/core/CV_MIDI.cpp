@@ -44,7 +44,13 @@ struct CV_MIDI : Module {
 	};
 
 	MidiOutput midiOutput;
-	float rateLimiterPhase = 0.f;
+	ScanClock scanClock{1000.f};
+	GateScanner gateScanner;
+	/** Clock, start, stop, and continue */
+	GateScanner triggerScanner;
+	/** Note and velocity of each channel at its last rising gate, so short notes keep their pitch */
+	int edgeNotes[16];
+	int edgeVels[16];
 
 	CV_MIDI() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -53,32 +59,63 @@ struct CV_MIDI : Module {
 
 	void onReset() override {
 		midiOutput.reset();
+		gateScanner.reset();
+		triggerScanner.reset();
+		for (int c = 0; c < 16; c++) {
+			edgeNotes[c] = 60;
+			edgeVels[c] = 100;
+		}
+	}
+
+	int getNote(int c) {
+		int note = (int) std::round(inputs[PITCH_INPUT].getVoltage(c) * 12.f + 60.f);
+		return clamp(note, 0, 127);
+	}
+
+	int getVelocity(int c) {
+		int vel = (int) std::round(inputs[VEL_INPUT].getNormalPolyVoltage(10.f * 100 / 127, c) / 10.f * 127);
+		return clamp(vel, 0, 127);
 	}
 
 	void process(const ProcessArgs& args) override {
-		const float rateLimiterPeriod = 0.005f;
-		rateLimiterPhase += args.sampleTime / rateLimiterPeriod;
-		if (rateLimiterPhase >= 1.f) {
-			rateLimiterPhase -= 1.f;
+		int channels = inputs[PITCH_INPUT].getChannels();
+
+		// Capture edges every sample, and the note and velocity of each rising gate
+		uint16_t rose = gateScanner.process(GateScanner::read(inputs[GATE_INPUT], channels));
+		for (int c = 0; rose; c++, rose >>= 1) {
+			if (rose & 1) {
+				edgeNotes[c] = getNote(c);
+				edgeVels[c] = getVelocity(c);
+			}
 		}
-		else {
+		uint16_t triggers = 0;
+		triggers |= (inputs[CLK_INPUT].getVoltage() >= 1.f) << 0;
+		triggers |= (inputs[START_INPUT].getVoltage() >= 1.f) << 1;
+		triggers |= (inputs[STOP_INPUT].getVoltage() >= 1.f) << 2;
+		triggers |= (inputs[CONTINUE_INPUT].getVoltage() >= 1.f) << 3;
+		triggerScanner.process(triggers);
+
+		if (!scanClock.process(args.sampleTime))
 			return;
-		}
 
-		for (int c = 0; c < inputs[PITCH_INPUT].getChannels(); c++) {
-			int vel = (int) std::round(inputs[VEL_INPUT].getNormalPolyVoltage(10.f * 100 / 127, c) / 10.f * 127);
-			vel = clamp(vel, 0, 127);
-			midiOutput.setVelocity(vel, c);
-
-			int note = (int) std::round(inputs[PITCH_INPUT].getVoltage(c) * 12.f + 60.f);
-			note = clamp(note, 0, 127);
-			bool gate = inputs[GATE_INPUT].getPolyVoltage(c) >= 1.f;
-			midiOutput.setNoteGate(note, gate, c);
+		for (int c = 0; c < channels; c++) {
+			int note = getNote(c);
+			if (gateScanner.hasFallen(c)) {
+				midiOutput.setNoteGate(note, false, c);
+			}
+			// A gate which rose and fell again since the last scan is sent with the note it rose with
+			if (gateScanner.hasRisen(c) && !gateScanner.isHigh(c)) {
+				midiOutput.setVelocity(edgeVels[c], c);
+				midiOutput.setNoteGate(edgeNotes[c], true, c);
+			}
+			midiOutput.setVelocity(getVelocity(c), c);
+			midiOutput.setNoteGate(note, gateScanner.isHigh(c), c);
 
 			int aft = (int) std::round(inputs[AFT_INPUT].getPolyVoltage(c) / 10.f * 127);
 			aft = clamp(aft, 0, 127);
 			midiOutput.setKeyPressure(aft, c);
 		}
+		gateScanner.clearEdges();
 
 		int pw = (int) std::round((inputs[PW_INPUT].getVoltage() + 5.f) / 10.f * 0x4000);
 		pw = clamp(pw, 0, 0x3fff);
@@ -96,22 +133,25 @@ struct CV_MIDI : Module {
 		pan = clamp(pan, 0, 127);
 		midiOutput.setPan(pan);
 
-		bool clk = inputs[CLK_INPUT].getVoltage() >= 1.f;
-		midiOutput.setClock(clk);
-
-		bool start = inputs[START_INPUT].getVoltage() >= 1.f;
-		midiOutput.setStart(start);
-
-		bool stop = inputs[STOP_INPUT].getVoltage() >= 1.f;
-		midiOutput.setStop(stop);
-
-		bool cont = inputs[CONTINUE_INPUT].getVoltage() >= 1.f;
-		midiOutput.setContinue(cont);
+		triggerScanner.scan(0, [&](bool clk) {
+			midiOutput.setClock(clk);
+		});
+		triggerScanner.scan(1, [&](bool start) {
+			midiOutput.setStart(start);
+		});
+		triggerScanner.scan(2, [&](bool stop) {
+			midiOutput.setStop(stop);
+		});
+		triggerScanner.scan(3, [&](bool cont) {
+			midiOutput.setContinue(cont);
+		});
+		triggerScanner.clearEdges();
 	}
 
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "midi", midiOutput.toJson());
+		json_object_set_new(rootJ, "scanRate", json_real(scanClock.rate));
 		return rootJ;
 	}
 
@@ -119,6 +159,10 @@ struct CV_MIDI : Module {
 		json_t* midiJ = json_object_get(rootJ, "midi");
 		if (midiJ)
 			midiOutput.fromJson(midiJ);
+
+		json_t* scanRateJ = json_object_get(rootJ, "scanRate");
+		if (scanRateJ)
+			scanClock.rate = math::clamp(json_number_value(scanRateJ), 1.f, 4000.f);
 	}
 };
 
@@ -165,6 +209,10 @@ struct CV_MIDIWidget : ModuleWidget {
 
 		menu->addChild(new MenuEntry);
 
+		ScanRateItem<CV_MIDI>* scanRateItem = createMenuItem<ScanRateItem<CV_MIDI>>("Scan rate", RIGHT_ARROW);
+		scanRateItem->module = module;
+		menu->addChild(scanRateItem);
+
 		CV_MIDIPanicItem* panicItem = new CV_MIDIPanicItem;
 		panicItem->text = "Panic";
 		panicItem->module = module;
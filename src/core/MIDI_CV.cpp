@@ -65,13 +65,20 @@ struct MIDI_CV : Module {
 
 	dsp::PulseGenerator clockPulse;
 	dsp::PulseGenerator clockDividerPulse;
-	dsp::PulseGenerator retriggerPulses[16];
+	dsp::TPulseGenerator<simd::float_4> retriggerPulses[4];
 	dsp::PulseGenerator startPulse;
 	dsp::PulseGenerator stopPulse;
 	dsp::PulseGenerator continuePulse;
 
 	MIDI_CV() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		outputs[GATE_OUTPUT].setEventStream(true);
+		outputs[RETRIGGER_OUTPUT].setEventStream(true);
+		outputs[CLOCK_OUTPUT].setEventStream(true);
+		outputs[CLOCK_DIV_OUTPUT].setEventStream(true);
+		outputs[START_OUTPUT].setEventStream(true);
+		outputs[STOP_OUTPUT].setEventStream(true);
+		outputs[CONTINUE_OUTPUT].setEventStream(true);
 		heldNotes.reserve(128);
 		for (int c = 0; c < 16; c++) {
 			pitchFilters[c].setTau(1 / 30.f);
@@ -119,10 +126,15 @@ struct MIDI_CV : Module {
 		outputs[RETRIGGER_OUTPUT].setChannels(channels);
 		for (int c = 0; c < channels; c++) {
 			outputs[CV_OUTPUT].setVoltage((notes[c] - 60.f) / 12.f, c);
-			outputs[GATE_OUTPUT].setVoltage(gates[c] ? 10.f : 0.f, c);
+			outputs[GATE_OUTPUT].setEventVoltage(gates[c] ? 10.f : 0.f, c);
 			outputs[VELOCITY_OUTPUT].setVoltage(rescale(velocities[c], 0, 127, 0.f, 10.f), c);
 			outputs[AFTERTOUCH_OUTPUT].setVoltage(rescale(aftertouches[c], 0, 127, 0.f, 10.f), c);
-			outputs[RETRIGGER_OUTPUT].setVoltage(retriggerPulses[c].process(args.sampleTime) ? 10.f : 0.f, c);
+		}
+		for (int c = 0; c < channels; c += 4) {
+			int retriggers = simd::movemask(retriggerPulses[c / 4].process(args.sampleTime));
+			for (int i = 0; i < 4 && c + i < channels; i++) {
+				outputs[RETRIGGER_OUTPUT].setEventVoltage((retriggers & (1 << i)) ? 10.f : 0.f, c + i);
+			}
 		}
 
 		if (polyMode == MPE_MODE) {
@@ -140,11 +152,11 @@ struct MIDI_CV : Module {
 			outputs[MOD_OUTPUT].setVoltage(modFilters[0].process(args.sampleTime, rescale(mods[0], 0, 127, 0.f, 10.f)));
 		}
 
-		outputs[CLOCK_OUTPUT].setVoltage(clockPulse.process(args.sampleTime) ? 10.f : 0.f);
-		outputs[CLOCK_DIV_OUTPUT].setVoltage(clockDividerPulse.process(args.sampleTime) ? 10.f : 0.f);
-		outputs[START_OUTPUT].setVoltage(startPulse.process(args.sampleTime) ? 10.f : 0.f);
-		outputs[STOP_OUTPUT].setVoltage(stopPulse.process(args.sampleTime) ? 10.f : 0.f);
-		outputs[CONTINUE_OUTPUT].setVoltage(continuePulse.process(args.sampleTime) ? 10.f : 0.f);
+		outputs[CLOCK_OUTPUT].setEventVoltage(clockPulse.process(args.sampleTime) ? 10.f : 0.f);
+		outputs[CLOCK_DIV_OUTPUT].setEventVoltage(clockDividerPulse.process(args.sampleTime) ? 10.f : 0.f);
+		outputs[START_OUTPUT].setEventVoltage(startPulse.process(args.sampleTime) ? 10.f : 0.f);
+		outputs[STOP_OUTPUT].setEventVoltage(stopPulse.process(args.sampleTime) ? 10.f : 0.f);
+		outputs[CONTINUE_OUTPUT].setEventVoltage(continuePulse.process(args.sampleTime) ? 10.f : 0.f);
 	}
 
 	void processMessage(midi::Message msg) {
@@ -314,7 +326,7 @@ struct MIDI_CV : Module {
 		// Set note
 		notes[*channel] = note;
 		gates[*channel] = true;
-		retriggerPulses[*channel].trigger(1e-3);
+		retriggerPulses[*channel / 4].trigger(simd::movemaskInverse<simd::float_4>(1 << (*channel % 4)), 1e-3f);
 	}
 
 	void releaseNote(uint8_t note) {
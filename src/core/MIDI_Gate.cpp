@@ -31,6 +31,9 @@ struct MIDI_Gate : Module {
 
 	MIDI_Gate() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		for (int i = 0; i < 16; i++) {
+			outputs[TRIG_OUTPUT + i].setEventStream(true);
+		}
 		onReset();
 	}
 
@@ -60,7 +63,7 @@ struct MIDI_Gate : Module {
 
 		for (int i = 0; i < 16; i++) {
 			if (gateTimes[i] > 0.f) {
-				outputs[TRIG_OUTPUT + i].setVoltage(velocityMode ? rescale(velocities[i], 0, 127, 0.f, 10.f) : 10.f);
+				outputs[TRIG_OUTPUT + i].setEventVoltage(velocityMode ? rescale(velocities[i], 0, 127, 0.f, 10.f) : 10.f);
 				// If the gate is off, wait 1 ms before turning the pulse off.
 				// This avoids drum controllers sending a pulse with 0 ms duration.
 				if (!gates[i]) {
@@ -68,7 +71,7 @@ struct MIDI_Gate : Module {
 				}
 			}
 			else {
-				outputs[TRIG_OUTPUT + i].setVoltage(0.f);
+				outputs[TRIG_OUTPUT + i].setEventVoltage(0.f);
 			}
 		}
 	}
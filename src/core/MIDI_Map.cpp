@@ -394,7 +394,7 @@ struct MIDI_MapChoice : LedDisplayChoice {
 		if (!m)
 			return "";
 		int paramId = paramHandle->paramId;
-		if (paramId >= (int) m->params.size())
+		if (paramId >= m->getNumParams())
 			return "";
 		ParamQuantity* paramQuantity = m->paramQuantities[paramId];
 		std::string s;
@@ -244,5 +244,120 @@ struct NoteChoice : LedDisplayChoice {
 };
 
 
+/** Divides the engine sample rate down to the rate at which CV-to-MIDI modules scan their inputs.
+MIDI can't carry more than about 1000 messages per second, so scanning every sample wastes CPU.
+*/
+struct ScanClock {
+	float rate;
+	float phase = 0.f;
+
+	ScanClock(float rate) : rate(rate) {}
+
+	/** Returns true when the inputs should be scanned. */
+	bool process(float sampleTime) {
+		phase += sampleTime * rate;
+		if (phase < 1.f)
+			return false;
+		phase -= 1.f;
+		// Scan rates above the sample rate scan every sample
+		if (phase >= 1.f)
+			phase = 0.f;
+		return true;
+	}
+};
+
+
+/** Remembers the edges of up to 16 gates between scans, so gates and retriggers shorter than the scan period are still sent. */
+struct GateScanner {
+	uint16_t gates = 0;
+	uint16_t rises = 0;
+	uint16_t falls = 0;
+
+	void reset() {
+		gates = 0;
+		rises = 0;
+		falls = 0;
+	}
+
+	/** Call every sample with a bitmask of the high gates.
+	Returns the gates which rose since the previous call.
+	*/
+	uint16_t process(uint16_t gates) {
+		uint16_t rose = gates & ~this->gates;
+		rises |= rose;
+		falls |= this->gates & ~gates;
+		this->gates = gates;
+		return rose;
+	}
+
+	/** Returns a bitmask of the channels of `input` at or above `threshold`. */
+	static uint16_t read(Input& input, int channels, float threshold = 1.f) {
+		int gates = 0;
+		for (int c = 0; c < channels; c += 4) {
+			simd::float_4 v = input.getPolyVoltageSimd<simd::float_4>(c);
+			gates |= simd::movemask(v >= threshold) << c;
+		}
+		return gates & ((1 << channels) - 1);
+	}
+
+	bool isHigh(int c) {
+		return gates & (1 << c);
+	}
+	bool hasRisen(int c) {
+		return rises & (1 << c);
+	}
+	bool hasFallen(int c) {
+		return falls & (1 << c);
+	}
+
+	/** Call after each scan. */
+	void clearEdges() {
+		rises = 0;
+		falls = 0;
+	}
+
+	/** Replays the edges of gate `c` since the last scan with `setGate(bool)`, then sets its current state.
+	Any number of edges collapse to at most off, on, off.
+	*/
+	template <typename F>
+	void scan(int c, F setGate) {
+		if (hasFallen(c))
+			setGate(false);
+		if (hasRisen(c))
+			setGate(true);
+		setGate(isHigh(c));
+	}
+};
+
+
+template <class TModule>
+struct ScanRateValueItem : MenuItem {
+	TModule* module;
+	float rate;
+	void onAction(const event::Action& e) override {
+		module->scanClock.rate = rate;
+	}
+};
+
+
+template <class TModule>
+struct ScanRateItem : MenuItem {
+	TModule* module;
+	Menu* createChildMenu() override {
+		Menu* menu = new Menu;
+		std::vector<float> rates = {100.f, 200.f, 500.f, 1000.f, 2000.f, 4000.f};
+		for (float rate : rates) {
+			ScanRateValueItem<TModule>* item = new ScanRateValueItem<TModule>;
+			item->text = string::f("%g Hz", rate);
+			item->rightText = CHECKMARK(module->scanClock.rate == rate);
+			item->module = module;
+			item->rate = rate;
+			menu->addChild(item);
+		}
+		return menu;
+	}
+};
+
+
 } // namespace core
 } // namespace rack
@@ -2,6 +2,8 @@
 #include <settings.hpp>
 #include <system.hpp>
 #include <random.hpp>
+#include <tracepoint.hpp>
+#include <simd/functions.hpp>
 
 #include <algorithm>
 #include <chrono>
@@ -10,6 +12,8 @@
 #include <mutex>
 #include <atomic>
 #include <tuple>
+#include <numeric>
+#include <functional>
 #include <pmmintrin.h>
 
 
@@ -41,20 +45,28 @@ struct VIPMutex {
 		while (count > 0)
 			cv.wait(lock);
 	}
+
+	void lock() {
+		std::unique_lock<std::mutex> lock(countMutex);
+		count++;
+	}
+
+	void unlock() {
+		std::unique_lock<std::mutex> lock(countMutex);
+		count--;
+		lock.unlock();
+		cv.notify_all();
+	}
 };
 
 
 struct VIPLock {
 	VIPMutex& m;
 	VIPLock(VIPMutex& m) : m(m) {
-		std::unique_lock<std::mutex> lock(m.countMutex);
-		m.count++;
+		m.lock();
 	}
 	~VIPLock() {
-		std::unique_lock<std::mutex> lock(m.countMutex);
-		m.count--;
-		lock.unlock();
-		m.cv.notify_all();
+		m.unlock();
 	}
 };
 
@@ -114,6 +126,12 @@ struct HybridBarrier {
 	std::atomic<bool> yield {false};
 
 	void wait() {
+		wait([] {});
+	}
+
+	/** Calls `idle()` repeatedly while spinning, e.g. to help other threads with their work. */
+	template <typename F>
+	void wait(F idle) {
 		int id = ++count;
 
 		// End and reset phase if this is the last thread
@@ -131,6 +149,7 @@ struct HybridBarrier {
 		while (!yield) {
 			if (count == 0)
 				return;
+			idle();
 			_mm_pause();
 		}
 
@@ -145,11 +164,74 @@ struct HybridBarrier {
 };
 
 
+/** Whether the current thread steps modules, i.e. is the engine thread or a worker */
+static thread_local bool engineThread = false;
+
+
+/** Loop posted by Engine::parallelFor() for idle threads to help with.
+Threads register as helpers before checking `active`, so the posting thread can wait for them to leave before the loop goes out of scope.
+*/
+struct ParallelJob {
+	void (*f)(void* context, int i);
+	void* context;
+	int n;
+	/** Context of the posting module, installed on every thread running the loop */
+	memory::Counter* memoryCounter = NULL;
+	bool deterministic = false;
+	uint64_t seed = 0;
+	std::atomic<int> next {0};
+	std::atomic<bool> active {false};
+	std::atomic<int> helpers {0};
+	/** Claimed by the thread posting a loop, so only one loop is shared at a time */
+	std::atomic<bool> busy {false};
+
+	void work() {
+		work([] {return false;});
+	}
+
+	/** Runs iterations until none are left or `stop()` returns true. */
+	template <typename F>
+	void work(F stop) {
+		memory::Scope memoryScope(memoryCounter);
+		while (!stop()) {
+			int i = next++;
+			if (i >= n)
+				break;
+			if (deterministic) {
+				// Derive a random stream for each iteration, so its random numbers don't depend on which thread runs it
+				uint64_t state[2];
+				random::seedState(state, seed + (uint64_t) i * 0x9e3779b97f4a7c15);
+				random::setState(state);
+			}
+			f(context, i);
+		}
+	}
+
+	/** Runs iterations of the posted loop, if any, until `stop()` returns true. */
+	template <typename F>
+	void help(F stop) {
+		if (!active)
+			return;
+		helpers++;
+		if (active) {
+			uint64_t state[2];
+			random::getState(state);
+			work(stop);
+			random::setState(state);
+		}
+		helpers--;
+	}
+};
+
+
 struct EngineWorker {
 	Engine* engine;
 	int id;
 	std::thread thread;
 	bool running = false;
+	/** CPU time of the thread during the last block, read by the engine thread to measure load */
+	double blockTime = 0.0;
+	double blockStartTime = 0.0;
 
 	void start() {
 		assert(!running);
@@ -183,7 +265,13 @@ struct Engine::Internal {
 	bool running = false;
 	float sampleRate;
 	float sampleTime;
+	std::atomic<Module*> primaryModule {NULL};
+	/** Sample rate of the primary module's device, or 0 if unknown */
+	std::atomic<float> suggestedSampleRate {0.f};
 	uint64_t frame = 0;
+	/** First frame and number of frames of the block being stepped */
+	uint64_t blockFrame = 0;
+	int blockFrames = 0;
 
 	int nextModuleId = 0;
 	int nextCableId = 0;
@@ -203,6 +291,38 @@ struct Engine::Internal {
 	HybridBarrier engineBarrier;
 	HybridBarrier workerBarrier;
 	std::atomic<int> workerModuleIndex;
+	ParallelJob parallelJob;
+	/** Set by yieldWorkers() when a module is about to block, e.g. while AudioInterface waits for the audio device. */
+	std::atomic<bool> yielded {false};
+	/** Outputs of all modules configured as wide buses */
+	std::vector<Output*> wideOutputs;
+
+	// Sticky scheduling
+	/** Whether modules are stepped by their assigned thread in `threadModules` rather than claimed dynamically with `workerModuleIndex`. */
+	bool partitioned = false;
+	/** Modules assigned to each thread ID */
+	std::vector<std::vector<Module*>> threadModules;
+	/** Set when the module graph or thread count changes, so the partition must be rebuilt. */
+	bool partitionDirty = true;
+	uint64_t partitionFrame = 0;
+
+	// Deterministic mode
+	bool deterministic = false;
+	uint64_t randomSeed = 0;
+
+	// Load shedding
+	/** Fraction of the block duration spent stepping modules, with exponential smoothing. */
+	float load = 0.f;
+	/** Modules degraded or suspended by load shedding, once for each action, in the order they were shed. */
+	std::vector<Module*> shedModules;
+	uint64_t shedFrame = 0;
+
+	// Delay compensation
+	/** Latency of each module in `modules` when cable delays were last computed */
+	std::vector<int> moduleLatencies;
+	/** Set when the cable graph or a module's latency changes, so cable delays must be recomputed by updateLatencyCompensation(). */
+	std::atomic<bool> latencyDirty {true};
+	bool delayCompensation = false;
 };
 
 
@@ -226,6 +346,178 @@ Engine::~Engine() {
 	delete internal;
 }
 
+/** Ring of blocks shared by the engine and the processing thread of an asynchronous block processor.
+The block collected during block `b` is stored in slot `b % asyncLatency`.
+The engine reuses the slot for the inputs of block `b + asyncLatency` while it reads the slot's outputs.
+*/
+struct Module::AsyncState {
+	struct Slot {
+		std::vector<float> inputVoltages;
+		std::vector<uint8_t> inputChannels;
+		std::vector<float> outputVoltages;
+		std::vector<uint8_t> outputChannels;
+		float sampleRate;
+	};
+	std::vector<Slot> slots;
+	/** Frame of the block currently being collected */
+	int frame = 0;
+	/** Number of blocks collected by the engine */
+	std::atomic<int64_t> submitted {0};
+	/** Number of blocks finished by the processing thread */
+	std::atomic<int64_t> processed {0};
+	bool running = true;
+	std::mutex mutex;
+	/** Notifies the processing thread when a block is submitted */
+	std::condition_variable submitCv;
+	/** Notifies the engine when a block is processed */
+	std::condition_variable processCv;
+	std::thread thread;
+};
+
+static void Engine_runAsync(Engine* that, Module* module) {
+	Module::AsyncState* state = module->asyncState;
+	system::setThreadName("Async");
+	system::setThreadRealTime(that->internal->realTime);
+	initMXCSR();
+
+	int blockSize = module->asyncBlockSize;
+	int latency = module->asyncLatency;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->submitCv.wait(lock, [&] {
+				return !state->running || state->processed < state->submitted;
+			});
+			if (!state->running)
+				break;
+		}
+
+		Module::AsyncState::Slot& slot = state->slots[state->processed % latency];
+		std::fill(slot.outputVoltages.begin(), slot.outputVoltages.end(), 0.f);
+		std::fill(slot.outputChannels.begin(), slot.outputChannels.end(), 1);
+
+		Module::ProcessBlockArgs args;
+		args.sampleRate = slot.sampleRate;
+		args.sampleTime = 1 / slot.sampleRate;
+		args.frames = blockSize;
+		args.inputVoltages = slot.inputVoltages.data();
+		args.inputChannels = slot.inputChannels.data();
+		args.outputVoltages = slot.outputVoltages.data();
+		args.outputChannels = slot.outputChannels.data();
+
+		bool deterministic = that->internal->deterministic;
+		if (deterministic)
+			random::setState(module->randomState);
+		double startTime = system::getThreadTime();
+		{
+			memory::Scope memoryScope(module->memoryCounter);
+			module->processBlock(args);
+		}
+		// The engine doesn't time asynchronous modules, so the CPU meter shows the time spent here per frame.
+		float cpuTime = (system::getThreadTime() - startTime) / blockSize;
+		const float cpuTau = 2.f /* seconds */;
+		module->cpuTime += (cpuTime - module->cpuTime) * std::fmin(blockSize * args.sampleTime / cpuTau, 1.f);
+		if (deterministic)
+			random::getState(module->randomState);
+
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->processed++;
+		}
+		state->processCv.notify_all();
+	}
+}
+
+static void Engine_startAsync(Engine* that, Module* module) {
+	Module::AsyncState* state = new Module::AsyncState;
+	int blockSize = module->asyncBlockSize;
+	state->slots.resize(module->asyncLatency);
+	for (Module::AsyncState::Slot& slot : state->slots) {
+		slot.inputVoltages.resize(module->getNumInputs() * blockSize * PORT_MAX_CHANNELS);
+		slot.inputChannels.resize(module->getNumInputs());
+		slot.outputVoltages.resize(module->getNumOutputs() * blockSize * PORT_MAX_CHANNELS);
+		slot.outputChannels.resize(module->getNumOutputs());
+		slot.sampleRate = that->internal->sampleRate;
+	}
+	module->asyncState = state;
+	state->thread = std::thread([=] {
+		random::init();
+		Engine_runAsync(that, module);
+	});
+}
+
+static void Engine_stopAsync(Module* module) {
+	Module::AsyncState* state = module->asyncState;
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->running = false;
+	}
+	state->submitCv.notify_all();
+	state->thread.join();
+	delete state;
+	module->asyncState = NULL;
+}
+
+/** Waits until the processing thread has finished all submitted blocks, so the Module's state can be changed from another thread. */
+static void Engine_drainAsync(Module* module) {
+	Module::AsyncState* state = module->asyncState;
+	if (!state)
+		return;
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->processCv.wait(lock, [&] {
+		return state->processed == state->submitted;
+	});
+}
+
+/** Exchanges one frame of voltages between the ports of an asynchronous block processor and its ring of blocks. */
+static void Engine_stepAsync(Engine* that, Module* module) {
+	Module::AsyncState* state = module->asyncState;
+	int blockSize = module->asyncBlockSize;
+	int latency = module->asyncLatency;
+	int64_t block = state->submitted;
+	Module::AsyncState::Slot& slot = state->slots[block % latency];
+	int frame = state->frame;
+
+	if (frame == 0) {
+		// Wait for the outputs due in this block if the processing thread has fallen behind.
+		// This only happens if processBlock() takes longer than the latency, and keeps the output independent of timing.
+		if (block >= latency && state->processed <= block - latency) {
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->processCv.wait(lock, [&] {
+				return state->processed > block - latency;
+			});
+		}
+		for (int i = 0; i < module->getNumInputs(); i++) {
+			slot.inputChannels[i] = module->getInput(i).channels;
+		}
+		slot.sampleRate = that->internal->sampleRate;
+	}
+
+	for (int i = 0; i < module->getNumInputs(); i++) {
+		Input& input = module->getInput(i);
+		std::memcpy(&slot.inputVoltages[(i * blockSize + frame) * PORT_MAX_CHANNELS], input.voltages, sizeof(input.voltages));
+	}
+	// Outputs stay at 0V until the first block is processed
+	if (block >= latency) {
+		for (int i = 0; i < module->getNumOutputs(); i++) {
+			Output& output = module->getOutput(i);
+			output.channels = slot.outputChannels[i];
+			std::memcpy(output.voltages, &slot.outputVoltages[(i * blockSize + frame) * PORT_MAX_CHANNELS], sizeof(output.voltages));
+		}
+	}
+
+	frame++;
+	if (frame >= blockSize) {
+		frame = 0;
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->submitted++;
+		}
+		state->submitCv.notify_one();
+	}
+	state->frame = frame;
+}
+
 static void Engine_stepModules(Engine* that, int threadId) {
 	Engine::Internal* internal = that->internal;
 
@@ -239,7 +531,8 @@ static void Engine_stepModules(Engine* that, int threadId) {
 	// Set up CPU meter
 	// Prime number to avoid synchronizing with power-of-2 buffers
 	const int timerDivider = 7;
-	bool timerEnabled = settings::cpuMeter && (internal->frame % timerDivider) == 0;
+	// Sticky scheduling and load shedding use CPU times, so they need the timer even if the meter is hidden.
+	bool timerEnabled = (settings::cpuMeter || internal->partitioned || settings::loadShedding) && (internal->frame % timerDivider) == 0;
 	double timerOverhead = 0.f;
 	if (timerEnabled) {
 		double startTime = system::getThreadTime();
@@ -247,20 +540,25 @@ static void Engine_stepModules(Engine* that, int threadId) {
 		timerOverhead = stopTime - startTime;
 	}
 
-	// Step each module
-	// for (int i = threadId; i < modulesLen; i += threadCount) {
-	while (true) {
-		// Choose next module
-		int i = internal->workerModuleIndex++;
-		if (i >= modulesLen)
-			break;
+	bool deterministic = internal->deterministic;
 
-		Module* module = internal->modules[i];
-		if (!module->bypass) {
+	auto stepModule = [&](Module* module) {
+		if (module->asyncState && !module->bypass && !module->suspended) {
+			// The Module's own thread calls processBlock(), so only its voltages are exchanged here.
+			Engine_stepAsync(that, module);
+		}
+		else if (!module->bypass && !module->suspended) {
+			// Switch to the module's random stream so its random numbers don't depend on which thread steps it
+			if (deterministic)
+				random::setState(module->randomState);
+			// Attribute allocations in process() to the module
+			memory::Scope memoryScope(module->memoryCounter);
 			// Step module
 			if (timerEnabled) {
 				double startTime = system::getThreadTime();
+				TRACEPOINT1(module_process_begin, module->id);
 				module->process(processArgs);
+				TRACEPOINT1(module_process_end, module->id);
 				double stopTime = system::getThreadTime();
 
 				float cpuTime = std::fmax(0.f, stopTime - startTime - timerOverhead);
@@ -269,30 +567,166 @@ static void Engine_stepModules(Engine* that, int threadId) {
 				module->cpuTime += (cpuTime - module->cpuTime) * timerDivider * processArgs.sampleTime / cpuTau;
 			}
 			else {
+				TRACEPOINT1(module_process_begin, module->id);
 				module->process(processArgs);
+				TRACEPOINT1(module_process_end, module->id);
 			}
+
+			if (deterministic)
+				random::getState(module->randomState);
 		}
 
 		// Iterate ports to step plug lights
-		for (Input& input : module->inputs) {
-			input.process(processArgs.sampleTime);
+		for (int i = 0; i < module->getNumInputs(); i++) {
+			module->getInput(i).process(processArgs.sampleTime);
+		}
+		for (int i = 0; i < module->getNumOutputs(); i++) {
+			module->getOutput(i).process(processArgs.sampleTime);
+		}
+	};
+
+	if (internal->partitioned) {
+		// Step the modules assigned to this thread
+		for (Module* module : internal->threadModules[threadId]) {
+			stepModule(module);
 		}
-		for (Output& output : module->outputs) {
-			output.process(processArgs.sampleTime);
+		return;
+	}
+
+	// Step each module
+	// for (int i = threadId; i < modulesLen; i += threadCount) {
+	while (true) {
+		// Choose next module
+		int i = internal->workerModuleIndex++;
+		if (i >= modulesLen)
+			break;
+
+		stepModule(internal->modules[i]);
+	}
+}
+
+/** Returns a mask of the voltages which are NaN, infinite, or denormal.
+Compares the exponent bits as integers, since float comparisons treat denormals as zero in DAZ mode.
+*/
+static simd::int32_4 getInvalidMask(simd::float_4 v) {
+	simd::int32_4 bits = simd::int32_4::cast(v);
+	simd::int32_4 exponent = bits & 0x7f800000;
+	simd::int32_4 mantissa = bits & 0x007fffff;
+	simd::int32_4 nonFinite = (exponent == 0x7f800000);
+	simd::int32_4 denormal = (exponent == 0) & ~(mantissa == 0);
+	return nonFinite | denormal;
+}
+
+/** Returns the ID of the first port with an invalid voltage on any of its channels, or -1.
+If `sanitize` is true, replaces all invalid voltages with 0V.
+*/
+template <class TPort>
+static int Port_checkVoltages(TPort* ports, int portsLen, bool sanitize) {
+	int portId = -1;
+	for (int i = 0; i < portsLen; i++) {
+		TPort& port = ports[i];
+		for (int c = 0; c < port.channels; c += 4) {
+			simd::float_4 v = simd::float_4::load(&port.voltages[c]);
+			simd::int32_4 invalid = getInvalidMask(v);
+			// Ignore channels past the port's channel count
+			int mask = simd::movemask(simd::float_4::cast(invalid)) & ((1 << std::min(port.channels - c, 4)) - 1);
+			if (!mask)
+				continue;
+			if (portId < 0)
+				portId = i;
+			if (!sanitize)
+				break;
+			v = simd::ifelse(simd::float_4::cast(invalid), 0.f, v);
+			v.store(&port.voltages[c]);
 		}
+		if (portId >= 0 && !sanitize)
+			break;
+	}
+	return portId;
+}
+
+/** Checks each module's outputs for invalid voltages at the end of a block.
+Modules whose inputs are also invalid are assumed to propagate rather than produce the invalid voltages, so only the origin is marked.
+*/
+static void Engine_checkVoltages(Engine* that) {
+	Engine::Internal* internal = that->internal;
+	for (Module* module : internal->modules) {
+		if (module->bypass || module->suspended)
+			continue;
+		if (module->faultOutputId >= 0)
+			continue;
+		int outputId = Port_checkVoltages(module->outputsData, module->getNumOutputs(), settings::sanitizeVoltages);
+		if (outputId < 0)
+			continue;
+		if (Port_checkVoltages(module->inputsData, module->getNumInputs(), false) >= 0)
+			continue;
+		module->faultOutputId = outputId;
+		std::string slug = module->model ? module->model->slug : "";
+		WARN("Module %s (%d) output %d produced a NaN, infinite, or denormal voltage", slug.c_str(), module->id, outputId + 1);
+	}
+}
+
+/** Steps a cable whose voltages are delayed by `compensationDelay` frames, along with their channel count and events. */
+static void Cable_stepDelayed(Cable* that, Output* output, Input* input) {
+	const int frameLen = PORT_MAX_CHANNELS + 2;
+	float* frame = &that->delayBuffer[that->delayIndex * frameLen];
+	// Read the oldest frame
+	int channels = frame[0];
+	input->eventStream = output->eventStream;
+	input->events = frame[1];
+	if (input->channels != channels)
+		input->events |= (1 << std::max((int) input->channels, channels)) - 1;
+	input->channels = channels;
+	// Cables from wide outputs aren't delayed, so this clears the bus of wide inputs.
+	if (input->wide)
+		input->wideBus = output->wideBus;
+	for (int i = 0; i < PORT_MAX_CHANNELS; i++) {
+		input->voltages[i] = frame[2 + i];
+	}
+	if (settings::checkVoltages && settings::sanitizeVoltages && that->outputModule->faultOutputId >= 0) {
+		Port_checkVoltages(input, 1, true);
+	}
+	// Replace it with the current frame
+	frame[0] = output->channels;
+	// Delay events reported on connection along with the voltages they refer to
+	frame[1] = output->events | input->pendingEvents;
+	input->pendingEvents = 0;
+	for (int i = 0; i < PORT_MAX_CHANNELS; i++) {
+		frame[2 + i] = (i < output->channels) ? output->voltages[i] : 0.f;
 	}
+	that->delayIndex++;
+	if (that->delayIndex >= that->compensationDelay)
+		that->delayIndex = 0;
 }
 
 static void Cable_step(Cable* that) {
-	Output* output = &that->outputModule->outputs[that->outputId];
-	Input* input = &that->inputModule->inputs[that->inputId];
+	Output* output = &that->outputModule->getOutput(that->outputId);
+	Input* input = &that->inputModule->getInput(that->inputId);
+	if (that->compensationDelay > 0) {
+		Cable_stepDelayed(that, output, input);
+		return;
+	}
 	// Match number of polyphonic channels to output port
 	int channels = output->channels;
+	// Forward events from the output.
+	// If the number of channels changes (e.g. when connecting), report events on all affected channels so event-driven inputs see the new voltages.
+	input->eventStream = output->eventStream;
+	input->events = output->events | input->pendingEvents;
+	input->pendingEvents = 0;
+	if (input->channels != channels)
+		input->events |= (1 << std::max((int) input->channels, channels)) - 1;
 	input->channels = channels;
+	// Wide inputs read the bus directly, so the voltages aren't copied.
+	if (input->wide)
+		input->wideBus = output->wideBus;
 	// Copy all voltages from output to input
 	for (int i = 0; i < channels; i++) {
 		input->voltages[i] = output->voltages[i];
 	}
+	// Replace invalid voltages from modules known to produce them
+	if (settings::checkVoltages && settings::sanitizeVoltages && that->outputModule->faultOutputId >= 0) {
+		Port_checkVoltages(input, 1, true);
+	}
 	// Clear all voltages of higher channels
 	for (int i = channels; i < PORT_MAX_CHANNELS; i++) {
 		input->voltages[i] = 0.f;
@@ -307,7 +741,7 @@ static void Engine_step(Engine* that) {
 	int smoothParamId = internal->smoothParamId;
 	float smoothValue = internal->smoothValue;
 	if (smoothModule) {
-		Param* param = &smoothModule->params[smoothParamId];
+		Param* param = &smoothModule->getParam(smoothParamId);
 		float value = param->value;
 		// Decay rate is 1 graphics frame
 		const float smoothLambda = 60.f;
@@ -323,6 +757,15 @@ static void Engine_step(Engine* that) {
 		}
 	}
 
+	// Flip wide buses, and send their first channels as normal voltages
+	for (Output* output : internal->wideOutputs) {
+		WideBus* wideBus = output->wideBus;
+		wideBus->flip();
+		for (int c = 0; c < output->channels; c++) {
+			output->voltages[c] = wideBus->front[c];
+		}
+	}
+
 	// Step cables
 	for (Cable* cable : that->internal->cables) {
 		Cable_step(cable);
@@ -342,9 +785,19 @@ static void Engine_step(Engine* that) {
 
 	// Step modules along with workers
 	internal->workerModuleIndex = 0;
+	// Barrier tracepoints pass the barrier (0 for engineBarrier, 1 for workerBarrier) and thread ID.
+	TRACEPOINT2(barrier_enter, 0, 0);
 	internal->engineBarrier.wait();
+	TRACEPOINT2(barrier_exit, 0, 0);
 	Engine_stepModules(that, 0);
-	internal->workerBarrier.wait();
+	TRACEPOINT2(barrier_enter, 1, 0);
+	internal->workerBarrier.wait([&] {
+		// Stop helping once all threads have reached the barrier
+		internal->parallelJob.help([&] {
+			return internal->workerBarrier.count == 0;
+		});
+	});
+	TRACEPOINT2(barrier_exit, 1, 0);
 
 	internal->frame++;
 }
@@ -353,13 +806,330 @@ static void Engine_updateExpander(Engine* that, Module::Expander* expander) {
 	if (expander->moduleId >= 0) {
 		if (!expander->module || expander->module->id != expander->moduleId) {
 			expander->module = that->getModule(expander->moduleId);
+			that->internal->partitionDirty = true;
 		}
 	}
 	else {
 		if (expander->module) {
 			expander->module = NULL;
+			that->internal->partitionDirty = true;
+		}
+	}
+}
+
+/** Assigns modules to threads for sticky scheduling.
+Modules connected by cables or expanders are greedily clustered so that producers and consumers share a core, and clusters are packed onto threads balanced by CPU time.
+In deterministic mode, modules linked by expanders are always placed in the same cluster.
+*/
+static void Engine_partitionModules(Engine* that) {
+	Engine::Internal* internal = that->internal;
+	int threadCount = std::max(internal->threadCount, 1);
+	int modulesLen = internal->modules.size();
+
+	std::map<Module*, int> moduleIndices;
+	for (int i = 0; i < modulesLen; i++) {
+		moduleIndices[internal->modules[i]] = i;
+	}
+
+	// Estimate the cost of each module by its CPU time.
+	// The constant accounts for per-module overhead and gives unmeasured modules equal weight.
+	const double minCost = 1e-7;
+	std::vector<double> costs(modulesLen);
+	double totalCost = 0.0;
+	for (int i = 0; i < modulesLen; i++) {
+		Module* module = internal->modules[i];
+		// Asynchronous modules are processed on their own threads, so they don't load the thread stepping them.
+		costs[i] = ((module->bypass || module->asyncState) ? 0.0 : module->cpuTime) + minCost;
+		totalCost += costs[i];
+	}
+
+	// Sum edge weights between pairs of modules.
+	// Expanders are added from both sides since they exchange messages every sample.
+	std::map<std::tuple<int, int>, float> edgeWeights;
+	auto addEdge = [&](Module* a, Module* b) {
+		auto itA = moduleIndices.find(a);
+		auto itB = moduleIndices.find(b);
+		if (itA == moduleIndices.end() || itB == moduleIndices.end())
+			return;
+		int i = std::min(itA->second, itB->second);
+		int j = std::max(itA->second, itB->second);
+		if (i == j)
+			return;
+		edgeWeights[std::make_tuple(i, j)] += 1.f;
+	};
+	for (Cable* cable : internal->cables) {
+		addEdge(cable->outputModule, cable->inputModule);
+	}
+	for (Module* module : internal->modules) {
+		addEdge(module, module->leftExpander.module);
+		addEdge(module, module->rightExpander.module);
+	}
+
+	std::vector<int> parents(modulesLen);
+	std::iota(parents.begin(), parents.end(), 0);
+	std::vector<double> clusterCosts = costs;
+	auto findRoot = [&](int i) {
+		while (parents[i] != i) {
+			parents[i] = parents[parents[i]];
+			i = parents[i];
+		}
+		return i;
+	};
+	auto merge = [&](int rootA, int rootB) {
+		parents[rootB] = rootA;
+		clusterCosts[rootA] += clusterCosts[rootB];
+	};
+
+	// Expander modules may access each other's state directly during process(), so in deterministic mode they must be stepped in a fixed order on one thread, whatever the cost.
+	if (internal->deterministic) {
+		for (int i = 0; i < modulesLen; i++) {
+			Module* module = internal->modules[i];
+			for (Module* expanderModule : {module->leftExpander.module, module->rightExpander.module}) {
+				auto it = moduleIndices.find(expanderModule);
+				if (it == moduleIndices.end())
+					continue;
+				int rootA = findRoot(i);
+				int rootB = findRoot(it->second);
+				if (rootA != rootB)
+					merge(rootA, rootB);
+			}
+		}
+	}
+
+	// Merge clusters along the heaviest edges first, without letting any cluster exceed the ideal load of one thread
+	std::vector<std::tuple<float, int, int>> edges;
+	for (auto& pair : edgeWeights) {
+		edges.push_back(std::make_tuple(pair.second, std::get<0>(pair.first), std::get<1>(pair.first)));
+	}
+	std::stable_sort(edges.begin(), edges.end(), [](const std::tuple<float, int, int>& a, const std::tuple<float, int, int>& b) {
+		return std::get<0>(a) > std::get<0>(b);
+	});
+
+	double maxClusterCost = totalCost / threadCount;
+	for (auto& edge : edges) {
+		int rootA = findRoot(std::get<1>(edge));
+		int rootB = findRoot(std::get<2>(edge));
+		if (rootA == rootB)
+			continue;
+		if (clusterCosts[rootA] + clusterCosts[rootB] > maxClusterCost)
+			continue;
+		merge(rootA, rootB);
+	}
+
+	// Collect clusters, keeping modules in engine order within each cluster
+	std::map<int, std::vector<Module*>> clusters;
+	for (int i = 0; i < modulesLen; i++) {
+		clusters[findRoot(i)].push_back(internal->modules[i]);
+	}
+	std::vector<int> roots;
+	for (auto& pair : clusters) {
+		roots.push_back(pair.first);
+	}
+	std::stable_sort(roots.begin(), roots.end(), [&](int a, int b) {
+		return clusterCosts[a] > clusterCosts[b];
+	});
+
+	// Place the largest clusters first, each on the least loaded thread
+	std::vector<double> threadCosts(threadCount, 0.0);
+	internal->threadModules.clear();
+	internal->threadModules.resize(threadCount);
+	for (int root : roots) {
+		int threadId = std::min_element(threadCosts.begin(), threadCosts.end()) - threadCosts.begin();
+		threadCosts[threadId] += clusterCosts[root];
+		std::vector<Module*>& threadModules = internal->threadModules[threadId];
+		threadModules.insert(threadModules.end(), clusters[root].begin(), clusters[root].end());
+	}
+
+	internal->partitionDirty = false;
+	internal->partitionFrame = internal->frame;
+}
+
+/** Returns whether the thread loads of the current partition have drifted far enough from balanced to rebuild it. */
+static bool Engine_isPartitionImbalanced(Engine* that) {
+	Engine::Internal* internal = that->internal;
+	// Give smoothed CPU times a chance to settle after repartitioning
+	const double settleTime = 4.0; // seconds
+	if (internal->frame - internal->partitionFrame < (uint64_t) (settleTime * internal->sampleRate))
+		return false;
+
+	double totalCost = 0.0;
+	double maxThreadCost = 0.0;
+	double maxModuleCost = 0.0;
+	for (const std::vector<Module*>& threadModules : internal->threadModules) {
+		double threadCost = 0.0;
+		for (Module* module : threadModules) {
+			threadCost += module->cpuTime;
+			maxModuleCost = std::max(maxModuleCost, (double) module->cpuTime);
+		}
+		totalCost += threadCost;
+		maxThreadCost = std::max(maxThreadCost, threadCost);
+	}
+	// The busiest thread can't do better than the mean load or the heaviest single module.
+	double bestCost = std::max(totalCost / internal->threadModules.size(), maxModuleCost);
+	const double tolerance = 0.25;
+	return bestCost > 0.0 && maxThreadCost > bestCost * (1 + tolerance);
+}
+
+/** Returns whether load shedding should degrade or suspend module `a` before module `b`. */
+static bool Module_isShedBefore(Module* a, Module* b) {
+	if (a->priority != b->priority)
+		return a->priority < b->priority;
+	bool aOverBudget = (a->cpuBudget > 0.f && a->cpuTime > a->cpuBudget);
+	bool bOverBudget = (b->cpuBudget > 0.f && b->cpuTime > b->cpuBudget);
+	if (aOverBudget != bOverBudget)
+		return aOverBudget;
+	return a->cpuTime > b->cpuTime;
+}
+
+/** Undoes the most recent load shedding action. */
+static void Engine_restoreShedModule(Engine* that) {
+	Engine::Internal* internal = that->internal;
+	Module* module = internal->shedModules.back();
+	internal->shedModules.pop_back();
+	if (module->suspended) {
+		module->suspended = false;
+	}
+	else {
+		module->degradeLevel--;
+		module->onDegrade(module->degradeLevel);
+	}
+}
+
+/** Degrades or suspends one module when the engine is close to missing its deadline, or restores one when there is headroom again.
+Modules are shed in order of priority, budget, and CPU time, and are restored in reverse order.
+*/
+static void Engine_shedLoad(Engine* that) {
+	Engine::Internal* internal = that->internal;
+
+	// Shedding depends on timing, which would make output nondeterministic.
+	if (!settings::loadShedding || internal->deterministic) {
+		while (!internal->shedModules.empty()) {
+			Engine_restoreShedModule(that);
+		}
+		return;
+	}
+
+	// Wait between actions so the load reflects the previous one
+	const double shedInterval = 0.5; // seconds
+	if (internal->frame - internal->shedFrame < (uint64_t) (shedInterval * internal->sampleRate))
+		return;
+
+	const float highLoad = 0.9f;
+	const float lowLoad = 0.6f;
+	if (internal->load > highLoad) {
+		Module* victim = NULL;
+		for (Module* module : internal->modules) {
+			if (module->bypass || module->suspended || module->priority == Module::PRIORITY_CRITICAL)
+				continue;
+			if (!victim || Module_isShedBefore(module, victim))
+				victim = module;
+		}
+		if (!victim)
+			return;
+
+		// Prefer lowering the module's quality, and suspend it if it refuses.
+		if (victim->onDegrade(victim->degradeLevel + 1)) {
+			victim->degradeLevel++;
+		}
+		else {
+			victim->suspended = true;
+			// Silence outputs rather than holding their last voltages
+			for (int i = 0; i < victim->getNumOutputs(); i++) {
+				Output& output = victim->getOutput(i);
+				for (int c = 0; c < output.getChannels(); c++) {
+					output.setVoltage(0.f, c);
+				}
+			}
+		}
+		internal->shedModules.push_back(victim);
+		internal->shedFrame = internal->frame;
+	}
+	else if (internal->load < lowLoad && !internal->shedModules.empty()) {
+		// Don't resume a suspended module if its last measured CPU time would overload the engine again.
+		Module* module = internal->shedModules.back();
+		if (module->suspended) {
+			float moduleLoad = module->cpuTime * internal->sampleRate / std::max(internal->threadCount, 1);
+			if (internal->load + moduleLoad > highLoad)
+				return;
+		}
+		Engine_restoreShedModule(that);
+		internal->shedFrame = internal->frame;
+	}
+}
+
+/** Sets the delay of each cable so that all inputs of each module arrive with the same latency, the greatest latency over the module's input paths.
+Latency is accumulated from Module::getLatency() along cables, ignoring the 1-frame delay of each cable.
+Cables which close a feedback loop are not delayed and don't contribute to the latency of the module they feed.
+*/
+static void Engine_compensateLatency(Engine* that) {
+	Engine::Internal* internal = that->internal;
+	int modulesLen = internal->modules.size();
+
+	std::map<Module*, int> moduleIndices;
+	for (int i = 0; i < modulesLen; i++) {
+		moduleIndices[internal->modules[i]] = i;
+	}
+	std::vector<std::vector<Cable*>> inputCables(modulesLen);
+	for (Cable* cable : internal->cables) {
+		inputCables[moduleIndices[cable->inputModule]].push_back(cable);
+	}
+
+	// Find the latency at which each module's inputs arrive with a depth-first search
+	std::vector<int> arrivals(modulesLen, -1);
+	std::vector<bool> visiting(modulesLen, false);
+	std::set<Cable*> feedbackCables;
+	std::function<int(int)> visit = [&](int i) {
+		if (arrivals[i] >= 0)
+			return arrivals[i];
+		visiting[i] = true;
+		int arrival = 0;
+		for (Cable* cable : inputCables[i]) {
+			int j = moduleIndices[cable->outputModule];
+			if (visiting[j]) {
+				feedbackCables.insert(cable);
+				continue;
+			}
+			arrival = std::max(arrival, visit(j) + internal->moduleLatencies[j]);
+		}
+		visiting[i] = false;
+		arrivals[i] = arrival;
+		return arrival;
+	};
+	for (int i = 0; i < modulesLen; i++) {
+		visit(i);
+	}
+
+	for (Cable* cable : internal->cables) {
+		int delay = 0;
+		// Wide buses are double-buffered in place, so they can't be delayed.
+		Output* output = &cable->outputModule->getOutput(cable->outputId);
+		if (internal->delayCompensation && !feedbackCables.count(cable) && !output->wideBus) {
+			int i = moduleIndices[cable->inputModule];
+			int j = moduleIndices[cable->outputModule];
+			delay = arrivals[i] - (arrivals[j] + internal->moduleLatencies[j]);
+		}
+		if (delay == cable->compensationDelay)
+			continue;
+		// Fill the delay line with the output's current channels and voltages, so the input doesn't appear disconnected while it fills.
+		std::vector<float> delayBuffer(delay * (PORT_MAX_CHANNELS + 2));
+		for (int k = 0; k < delay; k++) {
+			float* frame = &delayBuffer[k * (PORT_MAX_CHANNELS + 2)];
+			frame[0] = output->channels;
+			frame[1] = 0;
+			for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+				frame[2 + c] = output->voltages[c];
+			}
 		}
+		cable->compensationDelay = delay;
+		cable->delayBuffer.swap(delayBuffer);
+		cable->delayIndex = 0;
 	}
+	internal->latencyDirty = false;
+}
+
+/** Seeds the module's random stream from the engine seed and its ID, which is saved in the patch. */
+static void Engine_seedModule(Engine* that, Module* module) {
+	random::seedState(module->randomState, that->internal->randomSeed + (uint64_t) module->id * 0x9e3779b97f4a7c15);
 }
 
 static void Engine_relaunchWorkers(Engine* that, int threadCount, bool realTime) {
@@ -386,6 +1156,8 @@ static void Engine_relaunchWorkers(Engine* that, int threadCount, bool realTime)
 	// Set barrier counts
 	internal->engineBarrier.total = threadCount;
 	internal->workerBarrier.total = threadCount;
+	internal->partitioned = false;
+	internal->partitionDirty = true;
 
 	// Configure main thread
 	system::setThreadRealTime(realTime);
@@ -408,25 +1180,32 @@ static void Engine_run(Engine* that) {
 	system::setThreadName("Engine");
 	// system::setThreadRealTime();
 	initMXCSR();
+	engineThread = true;
 
 	internal->frame = 0;
-	// Every time the that waits and locks a mutex, it steps this many frames
-	const int mutexSteps = 128;
-	// Time in seconds that the that is rushing ahead of the estimated clock time
-	double aheadTime = 0.0;
-	auto lastTime = std::chrono::high_resolution_clock::now();
+	// Time when the current block should finish if the engine is paced by the system clock
+	double deadline = system::getTime();
+	// Last time a module blocked the engine
+	double blockedTime = -INFINITY;
 
 	while (internal->running) {
 		internal->vipMutex.wait();
 
-		// Set sample rate
-		if (internal->sampleRate != settings::sampleRate) {
-			internal->sampleRate = settings::sampleRate;
+		// Every time the engine waits and locks a mutex, it steps this many frames
+		int mutexSteps = math::clamp(settings::engineBlockSize, 1, 4096);
+
+		// Set sample rate, following the primary module's device if the setting is Auto.
+		// If there is no device, keep the current rate.
+		float sampleRate = settings::sampleRate;
+		if (sampleRate <= 0.f)
+			sampleRate = internal->suggestedSampleRate;
+		if (sampleRate > 0.f && internal->sampleRate != sampleRate) {
+			internal->sampleRate = sampleRate;
 			internal->sampleTime = 1 / internal->sampleRate;
 			for (Module* module : internal->modules) {
+				Engine_drainAsync(module);
 				module->onSampleRateChange();
 			}
-			aheadTime = 0.0;
 		}
 
 		if (!internal->paused) {
@@ -443,10 +1222,59 @@ static void Engine_run(Engine* that) {
 				Engine_updateExpander(that, &module->rightExpander);
 			}
 
+			// Switch deterministic mode, restarting all random streams so the output from here on only depends on the patch and seed
+			if (internal->deterministic != settings::deterministic || internal->randomSeed != settings::randomSeed) {
+				internal->deterministic = settings::deterministic;
+				internal->randomSeed = settings::randomSeed;
+				for (Module* module : internal->modules) {
+					Engine_seedModule(that, module);
+				}
+				internal->partitionDirty = true;
+			}
+
+			// Poll module latencies, so cable delays are recomputed by updateLatencyCompensation() if any have changed
+			if (!internal->latencyDirty && internal->moduleLatencies.size() == internal->modules.size()) {
+				for (size_t i = 0; i < internal->modules.size(); i++) {
+					if (internal->moduleLatencies[i] != std::max(internal->modules[i]->getLatency(), 0)) {
+						internal->latencyDirty = true;
+						break;
+					}
+				}
+			}
+
+			// Assign modules to threads
+			// Deterministic mode needs a fixed schedule of expander-linked modules, so it uses the same partitioning.
+			internal->partitioned = (settings::stickyThreads || internal->deterministic) && internal->threadCount > 1;
+			if (internal->partitioned && (internal->partitionDirty || Engine_isPartitionImbalanced(that))) {
+				Engine_partitionModules(that);
+			}
+
 			// Step modules
+			internal->blockFrame = internal->frame;
+			internal->blockFrames = mutexSteps;
+			double startTime = system::getThreadTime();
+			TRACEPOINT2(block_begin, internal->frame, mutexSteps);
 			for (int i = 0; i < mutexSteps; i++) {
 				Engine_step(that);
 			}
+			TRACEPOINT1(block_end, internal->frame);
+			// Threads sleep in the barriers instead of spinning after a module yields, so no single thread's CPU time covers the block.
+			// Use the busiest thread's CPU time, which also excludes time spent waiting for the audio device.
+			double blockTime = system::getThreadTime() - startTime;
+			for (EngineWorker& worker : internal->workers) {
+				blockTime = std::fmax(blockTime, worker.blockTime);
+			}
+
+			// Measure load relative to the time available for the block
+			double blockDuration = mutexSteps * internal->sampleTime;
+			const float loadTau = 0.1f /* seconds */;
+			float blockLoad = blockTime / blockDuration;
+			internal->load += (blockLoad - internal->load) * std::fmin(blockDuration / loadTau, 1.f);
+			Engine_shedLoad(that);
+
+			if (settings::checkVoltages) {
+				Engine_checkVoltages(that);
+			}
 		}
 		else {
 			// Stop workers while closed
@@ -455,19 +1283,23 @@ static void Engine_run(Engine* that) {
 			}
 		}
 
+		// Avoid pegging the CPU at 100% when there are no "blocking" modules like AudioInterface, by sleeping until each block's deadline.
+		// Deadlines are absolute, so sleep overshoot doesn't accumulate into drift.
 		double stepTime = mutexSteps * internal->sampleTime;
-		aheadTime += stepTime;
-		auto currTime = std::chrono::high_resolution_clock::now();
-		const double aheadFactor = 2.0;
-		aheadTime -= aheadFactor * std::chrono::duration<double>(currTime - lastTime).count();
-		lastTime = currTime;
-		aheadTime = std::fmax(aheadTime, 0.0);
-
-		// Avoid pegging the CPU at 100% when there are no "blocking" modules like AudioInterface, but still step audio at a reasonable rate
-		// The number of steps to wait before possibly sleeping
-		const double aheadMax = 1.0; // seconds
-		if (aheadTime > aheadMax) {
-			std::this_thread::sleep_for(std::chrono::duration<double>(stepTime));
+		deadline += stepTime;
+		double currTime = system::getTime();
+		if (internal->yielded.exchange(false)) {
+			blockedTime = currTime;
+		}
+		// If a module has blocked recently, it paces the engine with its own clock (e.g. an audio device), so don't throttle the engine below that clock.
+		const double blockedTimeout = 1.0; // seconds
+		// If the engine falls too far behind, skip ahead rather than stepping in a burst to catch up.
+		const double lagMax = 0.05; // seconds
+		if (currTime - blockedTime < blockedTimeout || currTime - deadline > lagMax) {
+			deadline = currTime;
+		}
+		else if (currTime < deadline) {
+			system::sleepUntil(deadline);
 		}
 	}
 
@@ -476,6 +1308,7 @@ static void Engine_run(Engine* that) {
 }
 
 void Engine::start() {
+	updateLatencyCompensation();
 	internal->running = true;
 	internal->thread = std::thread([&] {
 		random::init();
@@ -488,6 +1321,16 @@ void Engine::stop() {
 	internal->thread.join();
 }
 
+void Engine::lock() {
+	internal->vipMutex.lock();
+	internal->mutex.lock();
+}
+
+void Engine::unlock() {
+	internal->mutex.unlock();
+	internal->vipMutex.unlock();
+}
+
 void Engine::setPaused(bool paused) {
 	VIPLock vipLock(internal->vipMutex);
 	std::lock_guard<std::recursive_mutex> lock(internal->mutex);
@@ -509,12 +1352,77 @@ float Engine::getSampleTime() {
 
 void Engine::yieldWorkers() {
 	internal->workerBarrier.yield = true;
+	internal->yielded = true;
 }
 
 uint64_t Engine::getFrame() {
 	return internal->frame;
 }
 
+void Engine::updateLatencyCompensation() {
+	if (!internal->latencyDirty && internal->delayCompensation == settings::delayCompensation)
+		return;
+	VIPLock vipLock(internal->vipMutex);
+	std::lock_guard<std::recursive_mutex> lock(internal->mutex);
+	internal->delayCompensation = settings::delayCompensation;
+	internal->moduleLatencies.resize(internal->modules.size());
+	for (size_t i = 0; i < internal->modules.size(); i++) {
+		internal->moduleLatencies[i] = std::max(internal->modules[i]->getLatency(), 0);
+	}
+	Engine_compensateLatency(this);
+}
+
+void Engine::parallelFor(int n, void (*f)(void* context, int i), void* context) {
+	// Share the loop unless there are no other threads or they are already helping another loop.
+	// Loops posted outside of process(), e.g. by processBlock(), aren't shared since the workers may be between blocks.
+	ParallelJob& sharedJob = internal->parallelJob;
+	bool shared = n > 1 && engineThread && internal->threadCount > 1 && !sharedJob.busy.exchange(true);
+	ParallelJob inlineJob;
+	ParallelJob& job = shared ? sharedJob : inlineJob;
+
+	job.f = f;
+	job.context = context;
+	job.n = n;
+	job.next = 0;
+	// Run the iterations with the calling module's memory Counter and random streams, whichever thread they run on.
+	// Inline loops use the same streams, so results don't depend on whether workers are available.
+	job.memoryCounter = memory::getCounter();
+	job.deterministic = internal->deterministic;
+	job.seed = job.deterministic ? random::u64() : 0;
+	uint64_t state[2];
+	random::getState(state);
+	if (shared)
+		job.active = true;
+	job.work();
+	random::setState(state);
+	if (!shared)
+		return;
+	// Stop new helpers from joining, and wait for the others to finish their iterations
+	job.active = false;
+	while (job.helpers > 0) {
+		_mm_pause();
+	}
+	job.busy = false;
+}
+
+bool Engine::setPrimaryModule(Module* module) {
+	if (!module) {
+		internal->primaryModule = NULL;
+		internal->suggestedSampleRate = 0.f;
+		return true;
+	}
+	Module* expected = NULL;
+	return internal->primaryModule.compare_exchange_strong(expected, module) || expected == module;
+}
+
+Module* Engine::getPrimaryModule() {
+	return internal->primaryModule;
+}
+
+void Engine::setSuggestedSampleRate(float sampleRate) {
+	internal->suggestedSampleRate = sampleRate;
+}
+
 void Engine::addModule(Module* module) {
 	assert(module);
 	VIPLock vipLock(internal->vipMutex);
@@ -539,6 +1447,17 @@ void Engine::addModule(Module* module) {
 	}
 	// Add module
 	internal->modules.push_back(module);
+	internal->partitionDirty = true;
+	internal->latencyDirty = true;
+	Engine_seedModule(this, module);
+	for (int i = 0; i < module->getNumOutputs(); i++) {
+		if (module->getOutput(i).wideBus)
+			internal->wideOutputs.push_back(&module->getOutput(i));
+	}
+	// Start the processing thread of an asynchronous block processor
+	if (module->asyncBlockSize > 0) {
+		Engine_startAsync(this, module);
+	}
 	// Trigger Add event
 	module->onAdd();
 	// Update ParamHandles' module pointers
@@ -580,10 +1499,24 @@ void Engine::removeModule(Module* module) {
 			m->rightExpander.module = NULL;
 		}
 	}
+	// Forget load shedding actions on this module
+	internal->shedModules.erase(std::remove(internal->shedModules.begin(), internal->shedModules.end(), module), internal->shedModules.end());
+	if (module == internal->primaryModule)
+		setPrimaryModule(NULL);
 	// Trigger Remove event
 	module->onRemove();
+	if (module->asyncState) {
+		Engine_stopAsync(module);
+	}
 	// Remove module
 	internal->modules.erase(it);
+	internal->partitionDirty = true;
+	internal->latencyDirty = true;
+	for (int i = 0; i < module->getNumOutputs(); i++) {
+		auto wideIt = std::find(internal->wideOutputs.begin(), internal->wideOutputs.end(), &module->getOutput(i));
+		if (wideIt != internal->wideOutputs.end())
+			internal->wideOutputs.erase(wideIt);
+	}
 }
 
 Module* Engine::getModule(int moduleId) {
@@ -602,6 +1535,8 @@ void Engine::resetModule(Module* module) {
 	VIPLock vipLock(internal->vipMutex);
 	std::lock_guard<std::recursive_mutex> lock(internal->mutex);
 
+	module->faultOutputId = -1;
+	Engine_drainAsync(module);
 	module->onReset();
 }
 
@@ -610,6 +1545,7 @@ void Engine::randomizeModule(Module* module) {
 	VIPLock vipLock(internal->vipMutex);
 	std::lock_guard<std::recursive_mutex> lock(internal->mutex);
 
+	Engine_drainAsync(module);
 	module->onRandomize();
 }
 
@@ -620,14 +1556,17 @@ void Engine::bypassModule(Module* module, bool bypass) {
 	if (module->bypass == bypass)
 		return;
 	// Clear outputs and set to 1 channel
-	for (Output& output : module->outputs) {
+	for (int i = 0; i < module->getNumOutputs(); i++) {
 		// This zeros all voltages, but the channel is set to 1 if connected
-		output.setChannels(0);
+		module->getOutput(i).setChannels(0);
 	}
 	module->bypass = bypass;
 }
 
 static void Port_setDisconnected(Port* that) {
+	// Report the change to 0V on all channels to event-driven inputs
+	that->events = (1 << that->channels) - 1;
+	that->pendingEvents = 0;
 	that->channels = 0;
 	for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
 		that->voltages[c] = 0.f;
@@ -644,25 +1583,29 @@ static void Engine_updateConnected(Engine* that) {
 	// Find disconnected ports
 	std::set<Port*> disconnectedPorts;
 	for (Module* module : that->internal->modules) {
-		for (Output& output : module->outputs) {
-			disconnectedPorts.insert(&output);
+		for (int i = 0; i < module->getNumOutputs(); i++) {
+			disconnectedPorts.insert(&module->getOutput(i));
 		}
-		for (Input& input : module->inputs) {
-			disconnectedPorts.insert(&input);
+		for (int i = 0; i < module->getNumInputs(); i++) {
+			disconnectedPorts.insert(&module->getInput(i));
 		}
 	}
 	for (Cable* cable : that->internal->cables) {
 		// Connect output
-		Output& output = cable->outputModule->outputs[cable->outputId];
+		Output& output = cable->outputModule->getOutput(cable->outputId);
 		auto outputIt = disconnectedPorts.find(&output);
 		if (outputIt != disconnectedPorts.end())
 			disconnectedPorts.erase(outputIt);
 		Port_setConnected(&output);
 		// Connect input
-		Input& input = cable->inputModule->inputs[cable->inputId];
+		Input& input = cable->inputModule->getInput(cable->inputId);
 		auto inputIt = disconnectedPorts.find(&input);
 		if (inputIt != disconnectedPorts.end())
 			disconnectedPorts.erase(inputIt);
+		if (input.channels == 0) {
+			// Report the new voltages on all channels to event-driven inputs when the cable is first stepped, since the channel count may already match the output's.
+			input.pendingEvents = (1 << PORT_MAX_CHANNELS) - 1;
+		}
 		Port_setConnected(&input);
 	}
 	// Disconnect ports that have no cable
@@ -700,6 +1643,8 @@ void Engine::addCable(Cable* cable) {
 	}
 	// Add the cable
 	internal->cables.push_back(cable);
+	internal->partitionDirty = true;
+	internal->latencyDirty = true;
 	Engine_updateConnected(this);
 }
 
@@ -710,8 +1655,12 @@ void Engine::removeCable(Cable* cable) {
 	// Check that the cable is already added
 	auto it = std::find(internal->cables.begin(), internal->cables.end(), cable);
 	assert(it != internal->cables.end());
+	// Detach the input from the output's wide bus
+	cable->inputModule->getInput(cable->inputId).wideBus = NULL;
 	// Remove the cable
 	internal->cables.erase(it);
+	internal->partitionDirty = true;
+	internal->latencyDirty = true;
 	Engine_updateConnected(this);
 }
 
@@ -722,17 +1671,17 @@ void Engine::setParam(Module* module, int paramId, float value) {
 		internal->smoothModule = NULL;
 		internal->smoothParamId = 0;
 	}
-	module->params[paramId].value = value;
+	module->getParam(paramId).value = value;
 }
 
 float Engine::getParam(Module* module, int paramId) {
-	return module->params[paramId].value;
+	return module->getParam(paramId).value;
 }
 
 void Engine::setSmoothParam(Module* module, int paramId, float value) {
 	// If another param is being smoothed, jump value
 	if (internal->smoothModule && !(internal->smoothModule == module && internal->smoothParamId == paramId)) {
-		internal->smoothModule->params[internal->smoothParamId].value = internal->smoothValue;
+		internal->smoothModule->getParam(internal->smoothParamId).value = internal->smoothValue;
 	}
 	internal->smoothParamId = paramId;
 	internal->smoothValue = value;
@@ -844,13 +1793,29 @@ void EngineWorker::run() {
 	system::setThreadName("Engine worker");
 	system::setThreadRealTime(engine->internal->realTime);
 	initMXCSR();
+	engineThread = true;
 
 	while (1) {
+		TRACEPOINT2(barrier_enter, 0, id);
 		engine->internal->engineBarrier.wait();
+		TRACEPOINT2(barrier_exit, 0, id);
 		if (!running)
 			return;
+		// Measure CPU time over the block for the engine's load
+		uint64_t frame = engine->internal->frame;
+		if (frame == engine->internal->blockFrame)
+			blockStartTime = system::getThreadTime();
 		Engine_stepModules(engine, id);
-		engine->internal->workerBarrier.wait();
+		if (frame + 1 == engine->internal->blockFrame + engine->internal->blockFrames)
+			blockTime = system::getThreadTime() - blockStartTime;
+		TRACEPOINT2(barrier_enter, 1, id);
+		// Help modules which are still stepping with their parallel loops
+		engine->internal->workerBarrier.wait([&] {
+			engine->internal->parallelJob.help([&] {
+				return engine->internal->workerBarrier.count == 0;
+			});
+		});
+		TRACEPOINT2(barrier_exit, 1, id);
 	}
 }
 
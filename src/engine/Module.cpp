@@ -14,6 +14,12 @@ Module::~Module() {
 		if (paramQuantity)
 			delete paramQuantity;
 	}
+	for (WideBus* wideBus : wideBuses) {
+		delete wideBus;
+	}
+	// The Module's own block is freed after this destructor, so the Counter lives until then.
+	if (memoryCounter)
+		memory::release(memoryCounter);
 }
 
 void Module::config(int numParams, int numInputs, int numOutputs, int numLights) {
@@ -23,6 +29,20 @@ void Module::config(int numParams, int numInputs, int numOutputs, int numLights)
 	inputs.resize(numInputs);
 	outputs.resize(numOutputs);
 	lights.resize(numLights);
+	configArrays(params.data(), numParams, inputs.data(), numInputs, outputs.data(), numOutputs, lights.data(), numLights);
+}
+
+void Module::configArrays(Param* params, int numParams, Input* inputs, int numInputs, Output* outputs, int numOutputs, Light* lights, int numLights) {
+	// This method should only be called once.
+	assert(paramQuantities.empty());
+	paramsData = params;
+	inputsData = inputs;
+	outputsData = outputs;
+	lightsData = lights;
+	this->numParams = numParams;
+	this->numInputs = numInputs;
+	this->numOutputs = numOutputs;
+	this->numLights = numLights;
 	paramQuantities.resize(numParams);
 	// Initialize paramQuantities
 	for (int i = 0; i < numParams; i++) {
@@ -30,6 +50,28 @@ void Module::config(int numParams, int numInputs, int numOutputs, int numLights)
 	}
 }
 
+void Module::configWideOutput(int outputId, int maxChannels) {
+	assert(outputId < numOutputs);
+	assert(maxChannels > 0);
+	Output& output = outputsData[outputId];
+	assert(!output.wideBus);
+	output.wide = true;
+	output.wideBus = new WideBus(maxChannels);
+	wideBuses.push_back(output.wideBus);
+}
+
+void Module::configWideInput(int inputId) {
+	assert(inputId < numInputs);
+	inputsData[inputId].wide = true;
+}
+
+void Module::configAsync(int blockSize, int latency) {
+	assert(blockSize > 0);
+	assert(latency >= 2);
+	asyncBlockSize = blockSize;
+	asyncLatency = latency;
+}
+
 json_t* Module::toJson() {
 	json_t* rootJ = json_object();
 
@@ -47,7 +89,7 @@ json_t* Module::toJson() {
 
 	// params
 	json_t* paramsJ = json_array();
-	for (size_t paramId = 0; paramId < params.size(); paramId++) {
+	for (int paramId = 0; paramId < numParams; paramId++) {
 		// Don't serialize unbounded Params
 		if (!paramQuantities[paramId]->isBounded())
 			continue;
@@ -56,7 +98,7 @@ json_t* Module::toJson() {
 
 		json_object_set_new(paramJ, "id", json_integer(paramId));
 
-		float value = params[paramId].getValue();
+		float value = getParam(paramId).getValue();
 		json_object_set_new(paramJ, "value", json_real(value));
 
 		json_array_append(paramsJ, paramJ);
@@ -143,7 +185,7 @@ void Module::fromJson(json_t* rootJ) {
 			paramId = i;
 
 		// Check ID bounds
-		if (paramId >= params.size())
+		if (paramId >= (size_t) numParams)
 			continue;
 
 		// Check that the Param is bounded
@@ -152,7 +194,7 @@ void Module::fromJson(json_t* rootJ) {
 
 		json_t* valueJ = json_object_get(paramJ, "value");
 		if (valueJ)
-			params[paramId].setValue(json_number_value(valueJ));
+			getParam(paramId).setValue(json_number_value(valueJ));
 	}
 
 	// bypass
@@ -173,8 +215,10 @@ void Module::fromJson(json_t* rootJ) {
 
 	// data
 	json_t* dataJ = json_object_get(rootJ, "data");
-	if (dataJ)
+	if (dataJ) {
+		memory::Scope memoryScope(memoryCounter);
 		dataFromJson(dataJ);
+	}
 }
 
 
@@ -9,7 +9,7 @@ namespace engine {
 
 engine::Param* ParamQuantity::getParam() {
 	assert(module);
-	return &module->params[paramId];
+	return &module->getParam(paramId);
 }
 
 void ParamQuantity::setSmoothValue(float smoothValue) {
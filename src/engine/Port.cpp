@@ -5,7 +5,27 @@ namespace rack {
 namespace engine {
 
 
+WideBus::WideBus(int maxChannels) {
+	this->maxChannels = maxChannels;
+	// Round up to whole 8-float blocks, and over-allocate so both buffers can be aligned to 32 bytes.
+	int bufferLen = (maxChannels + 7) / 8 * 8;
+	storage = new float[2 * bufferLen + 8]();
+	float* aligned = (float*) (((uintptr_t) storage + 31) & ~(uintptr_t) 31);
+	front = aligned;
+	back = aligned + bufferLen;
+}
+
+WideBus::~WideBus() {
+	delete[] storage;
+}
+
+
 void Port::process(float deltaTime) {
+	// Send events emitted by the module's last process() call.
+	// For inputs, this clears events received from the cable after they have been consumed.
+	events = pendingEvents;
+	pendingEvents = 0;
+
 	// Set plug lights
 	if (channels == 0) {
 		plugLights[0].setBrightness(0.f);
@@ -116,13 +116,13 @@ void ModuleChange::redo() {
 void ParamChange::undo() {
 	app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
 	assert(mw);
-	mw->module->params[paramId].value = oldValue;
+	mw->module->getParam(paramId).value = oldValue;
 }
 
 void ParamChange::redo() {
 	app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
 	assert(mw);
-	mw->module->params[paramId].value = newValue;
+	mw->module->getParam(paramId).value = newValue;
 }
 
 
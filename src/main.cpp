@@ -18,6 +18,7 @@
 #include <string.hpp>
 #include <updater.hpp>
 #include <network.hpp>
+#include <startup.hpp>
 
 #include <osdialog.h>
 #include <thread>
@@ -53,6 +54,13 @@ static void fatalSignalHandler(int sig) {
 }
 
 
+template <typename F>
+static void initPhase(const std::string& name, F f) {
+	startup::Timer timer("phase", name);
+	f();
+}
+
+
 int main(int argc, char* argv[]) {
 #if defined ARCH_WIN
 	// Windows global mutex to prevent multiple instances
@@ -104,8 +112,8 @@ int main(int argc, char* argv[]) {
 	}
 
 	// Initialize environment
-	asset::init();
-	logger::init();
+	initPhase("asset::init", asset::init);
+	initPhase("logger::init", logger::init);
 
 	// We can now install a signal handler and log the output
 	if (!settings::devMode) {
@@ -135,7 +143,9 @@ int main(int argc, char* argv[]) {
 
 	// Load settings
 	try {
-		settings::load(asset::settingsPath);
+		initPhase("settings::load", []() {
+			settings::load(asset::settingsPath);
+		});
 	}
 	catch (UserException& e) {
 		std::string msg = e.what();
@@ -155,22 +165,22 @@ int main(int argc, char* argv[]) {
 
 	INFO("Initializing environment");
 	random::init();
-	network::init();
-	midi::init();
-	rtmidiInit();
-	bridgeInit();
-	keyboard::init();
-	gamepad::init();
-	plugin::init();
-	updater::init();
+	initPhase("network::init", network::init);
+	initPhase("midi::init", midi::init);
+	initPhase("rtmidiInit", rtmidiInit);
+	initPhase("bridgeInit", bridgeInit);
+	initPhase("keyboard::init", keyboard::init);
+	initPhase("gamepad::init", gamepad::init);
+	initPhase("plugin::init", plugin::init);
+	initPhase("updater::init", updater::init);
 	if (!settings::headless) {
-		ui::init();
-		windowInit();
+		initPhase("ui::init", ui::init);
+		initPhase("windowInit", windowInit);
 	}
 
 	// Initialize app
 	INFO("Initializing app");
-	appInit();
+	initPhase("appInit", appInit);
 
 	// On Mac, use a hacked-in GLFW addition to get the launched path.
 #if defined ARCH_MAC
@@ -184,11 +194,16 @@ int main(int argc, char* argv[]) {
 #endif
 
 	if (!settings::headless) {
-		APP->patch->init(patchPath);
+		initPhase("patch->init", [&]() {
+			APP->patch->init(patchPath);
+		});
 	}
 
 	INFO("Starting engine");
-	APP->engine->start();
+	initPhase("engine->start", []() {
+		APP->engine->start();
+	});
+	startup::finish();
 
 	if (settings::headless) {
 		// TEMP Prove that the app doesn't crash
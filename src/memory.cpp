@@ -0,0 +1,125 @@
+#include <memory.hpp>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+
+namespace rack {
+namespace memory {
+
+
+static thread_local Counter* currentCounter = NULL;
+
+
+void release(Counter* counter) {
+	if (counter->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		delete counter;
+}
+
+
+Scope::Scope(Counter* counter) {
+	prevCounter = currentCounter;
+	currentCounter = counter;
+}
+
+
+Scope::~Scope() {
+	currentCounter = prevCounter;
+}
+
+
+Counter* getCounter() {
+	return currentCounter;
+}
+
+
+#if !defined ARCH_WIN
+
+/** Stored before each block, so the block is subtracted from the Counter that allocated it when it's freed.
+Aligned so that blocks keep the alignment of malloc().
+*/
+struct alignas(alignof(std::max_align_t)) Header {
+	Counter* counter;
+	size_t size;
+};
+
+
+static void* allocate(size_t size) {
+	Header* header;
+	while (!(header = (Header*) std::malloc(sizeof(Header) + size))) {
+		std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			return NULL;
+		handler();
+	}
+	Counter* counter = currentCounter;
+	header->counter = counter;
+	header->size = size;
+	if (counter) {
+		counter->refs.fetch_add(1, std::memory_order_relaxed);
+		counter->bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+	return header + 1;
+}
+
+
+static void deallocate(void* p) {
+	if (!p)
+		return;
+	Header* header = (Header*) p - 1;
+	Counter* counter = header->counter;
+	if (counter) {
+		counter->bytes.fetch_sub(header->size, std::memory_order_relaxed);
+		release(counter);
+	}
+	std::free(header);
+}
+
+#endif
+
+
+} // namespace memory
+} // namespace rack
+
+
+#if !defined ARCH_WIN
+
+// Replacements of the global allocation functions.
+// Plugins resolve these symbols to Rack's on Linux and Mac.
+
+void* operator new(std::size_t size) {
+	void* p = rack::memory::allocate(size);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return rack::memory::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return rack::memory::allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+	rack::memory::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept {
+	rack::memory::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+	rack::memory::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+	rack::memory::deallocate(p);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include <midi.hpp>
 #include <string.hpp>
+#include <tracepoint.hpp>
 #include <map>
 
 
@@ -28,6 +29,7 @@ void InputDevice::unsubscribe(Input* input) {
 }
 
 void InputDevice::onMessage(Message message) {
+	TRACEPOINT3(midi_message, message.bytes[0], message.bytes[1], message.bytes[2]);
 	for (Input* input : subscribed) {
 		// Filter channel
 		if (input->channel < 0 || message.getStatus() == 0xf || message.getChannel() == input->channel) {
@@ -7,8 +7,13 @@
 #include <app/RackWidget.hpp>
 #include <history.hpp>
 #include <settings.hpp>
+#include <tracepoint.hpp>
+#include <startup.hpp>
+#include <engine/Engine.hpp>
 
 #include <osdialog.h>
+#include <thread>
+#include <atomic>
 
 
 namespace rack {
@@ -17,12 +22,61 @@ namespace rack {
 static const char PATCH_FILTERS[] = "VCV Rack patch (.vcv):vcv";
 
 
+struct PatchManager::Internal {
+	// Preloading
+	std::string preloadPath;
+	std::thread preloadThread;
+	/** Set by the preload thread when `preloadJ` is ready */
+	std::atomic<bool> preloadParsed {false};
+	json_t* preloadJ = NULL;
+	/** Whether `preloadModules` have been constructed from `preloadJ` */
+	bool preloadBuilt = false;
+	/** Index of the next module in `preloadJ` to construct */
+	size_t preloadModuleIndex = 0;
+	int preloadLegacy = 0;
+	std::string preloadWarningLog;
+	std::vector<app::ModuleWidget*> preloadModules;
+	/** "data" object of each of `preloadModules`, or NULL.
+	dataFromJson() is deferred until the swap, since it can open devices or map params of the running patch.
+	*/
+	std::vector<json_t*> preloadData;
+};
+
+
+/** Stops preloading and frees the staged patch. */
+static void PatchManager_clearPreload(PatchManager* that) {
+	PatchManager::Internal* internal = that->internal;
+	if (internal->preloadThread.joinable())
+		internal->preloadThread.join();
+	if (internal->preloadJ)
+		json_decref(internal->preloadJ);
+	internal->preloadJ = NULL;
+	internal->preloadParsed = false;
+	internal->preloadBuilt = false;
+	internal->preloadModuleIndex = 0;
+	for (app::ModuleWidget* moduleWidget : internal->preloadModules) {
+		delete moduleWidget;
+	}
+	internal->preloadModules.clear();
+	for (json_t* dataJ : internal->preloadData) {
+		if (dataJ)
+			json_decref(dataJ);
+	}
+	internal->preloadData.clear();
+	internal->preloadWarningLog = "";
+	internal->preloadPath = "";
+}
+
+
 PatchManager::PatchManager() {
+	internal = new Internal;
 	path = settings::patchPath;
 }
 
 PatchManager::~PatchManager() {
 	settings::patchPath = path;
+	PatchManager_clearPreload(this);
+	delete internal;
 }
 
 void PatchManager::init(std::string path) {
@@ -161,6 +215,8 @@ void PatchManager::saveTemplateDialog() {
 
 bool PatchManager::load(std::string path) {
 	INFO("Loading patch %s", path.c_str());
+	TRACEPOINT1(patch_load_begin, path.c_str());
+	startup::Timer timer("patch", path);
 	FILE* file = std::fopen(path.c_str(), "r");
 	if (!file) {
 		// Exit silently
@@ -172,6 +228,7 @@ bool PatchManager::load(std::string path) {
 
 	json_error_t error;
 	json_t* rootJ = json_loadf(file, 0, &error);
+	TRACEPOINT(patch_parse_end);
 	if (!rootJ) {
 		std::string message = string::f("JSON parsing error at %s %d:%d %s", error.source, error.line, error.column, error.text);
 		osdialog_message(OSDIALOG_WARNING, OSDIALOG_OK, message.c_str());
@@ -184,8 +241,10 @@ bool PatchManager::load(std::string path) {
 	APP->history->clear();
 	APP->scene->rack->clear();
 	APP->scene->rackScroll->reset();
+	TRACEPOINT(patch_clear_end);
 	legacy = 0;
 	fromJson(rootJ);
+	TRACEPOINT(patch_load_end);
 	return true;
 }
 
@@ -261,7 +320,9 @@ json_t* PatchManager::toJson() {
 	return rootJ;
 }
 
-void PatchManager::fromJson(json_t* rootJ) {
+/** Sets `legacy` from the version of the patch. */
+static void PatchManager_checkVersion(PatchManager* that, json_t* rootJ) {
+	int& legacy = that->legacy;
 	legacy = 0;
 
 	// version
@@ -284,6 +345,10 @@ void PatchManager::fromJson(json_t* rootJ) {
 	if (legacy) {
 		INFO("Loading patch using legacy mode %d", legacy);
 	}
+}
+
+void PatchManager::fromJson(json_t* rootJ) {
+	PatchManager_checkVersion(this, rootJ);
 
 	APP->scene->rack->fromJson(rootJ);
 
@@ -294,6 +359,160 @@ void PatchManager::fromJson(json_t* rootJ) {
 	warningLog = "";
 }
 
+void PatchManager::preload(std::string path) {
+	PatchManager_clearPreload(this);
+	INFO("Preloading patch %s", path.c_str());
+	internal->preloadPath = path;
+	internal->preloadThread = std::thread([this, path] {
+		json_error_t error;
+		json_t* rootJ = json_load_file(path.c_str(), 0, &error);
+		if (!rootJ) {
+			WARN("JSON parsing error at %s %d:%d %s", error.source, error.line, error.column, error.text);
+		}
+		internal->preloadJ = rootJ;
+		internal->preloadParsed = true;
+	});
+}
+
+void PatchManager::preloadDialog() {
+	std::string dir;
+	if (path.empty()) {
+		dir = asset::user("patches");
+		system::createDirectory(dir);
+	}
+	else {
+		dir = string::directory(path);
+	}
+
+	osdialog_filters* filters = osdialog_filters_parse(PATCH_FILTERS);
+	DEFER({
+		osdialog_filters_free(filters);
+	});
+
+	char* pathC = osdialog_file(OSDIALOG_OPEN, dir.c_str(), NULL, filters);
+	if (!pathC) {
+		// Fail silently
+		return;
+	}
+	DEFER({
+		std::free(pathC);
+	});
+
+	preload(pathC);
+}
+
+bool PatchManager::isPreloaded() {
+	return internal->preloadBuilt;
+}
+
+std::string PatchManager::getPreloadPath() {
+	return internal->preloadPath;
+}
+
+void PatchManager::step() {
+	if (internal->preloadBuilt || !internal->preloadParsed)
+		return;
+	if (internal->preloadThread.joinable())
+		internal->preloadThread.join();
+	if (!internal->preloadJ) {
+		PatchManager_clearPreload(this);
+		return;
+	}
+
+	// Construct modules and widgets on the UI thread, since panels need the graphics context.
+	// They aren't added to the engine yet, so the current patch keeps running.
+	// Spread construction over several frames so large patches don't freeze the UI.
+	const double budget = 0.004;
+	double startTime = system::getTime();
+	int oldLegacy = legacy;
+	std::string oldWarningLog = warningLog;
+	if (internal->preloadModuleIndex == 0) {
+		warningLog = "";
+		PatchManager_checkVersion(this, internal->preloadJ);
+		internal->preloadLegacy = legacy;
+	}
+	else {
+		legacy = internal->preloadLegacy;
+		warningLog = internal->preloadWarningLog;
+	}
+	json_t* modulesJ = json_object_get(internal->preloadJ, "modules");
+	size_t modulesLen = modulesJ ? json_array_size(modulesJ) : 0;
+	while (internal->preloadModuleIndex < modulesLen) {
+		size_t moduleIndex = internal->preloadModuleIndex++;
+		json_t* moduleJ = json_array_get(modulesJ, moduleIndex);
+		// Set the module's data aside, so it's loaded at the swap
+		json_t* dataJ = json_object_get(moduleJ, "data");
+		if (dataJ) {
+			json_incref(dataJ);
+			json_object_del(moduleJ, "data");
+		}
+		app::ModuleWidget* moduleWidget = APP->scene->rack->moduleWidgetFromJson(moduleJ, moduleIndex);
+		if (moduleWidget) {
+			internal->preloadModules.push_back(moduleWidget);
+			internal->preloadData.push_back(dataJ);
+		}
+		else if (dataJ) {
+			json_decref(dataJ);
+		}
+		if (system::getTime() - startTime >= budget)
+			break;
+	}
+	internal->preloadWarningLog = warningLog;
+	legacy = oldLegacy;
+	warningLog = oldWarningLog;
+	if (internal->preloadModuleIndex < modulesLen)
+		return;
+	internal->preloadBuilt = true;
+	INFO("Preloaded patch %s", internal->preloadPath.c_str());
+}
+
+bool PatchManager::loadPreloaded() {
+	if (!internal->preloadBuilt)
+		return false;
+	INFO("Switching to preloaded patch %s", internal->preloadPath.c_str());
+
+	APP->engine->lock();
+	APP->history->clear();
+	APP->scene->rack->clear();
+	APP->engine->unlock();
+	APP->scene->rackScroll->reset();
+	legacy = internal->preloadLegacy;
+
+	// Load the modules' data now that the old patch has released its devices.
+	// The engine isn't held meanwhile, since opening a device can block.
+	for (size_t i = 0; i < internal->preloadModules.size(); i++) {
+		json_t* dataJ = internal->preloadData[i];
+		engine::Module* module = internal->preloadModules[i]->module;
+		if (!dataJ || !module)
+			continue;
+		json_t* moduleJ = json_object();
+		json_object_set(moduleJ, "data", dataJ);
+		module->fromJson(moduleJ);
+		json_decref(moduleJ);
+	}
+
+	// Add the new patch between two blocks
+	APP->engine->lock();
+	for (app::ModuleWidget* moduleWidget : internal->preloadModules) {
+		APP->scene->rack->addModule(moduleWidget);
+	}
+	internal->preloadModules.clear();
+	APP->scene->rack->cablesFromJson(internal->preloadJ);
+	APP->engine->unlock();
+
+	path = internal->preloadPath;
+	APP->history->setSaved();
+	warningLog += internal->preloadWarningLog;
+	PatchManager_clearPreload(this);
+
+	// Display a message if we have something to say
+	if (!warningLog.empty()) {
+		osdialog_message(OSDIALOG_WARNING, OSDIALOG_OK, warningLog.c_str());
+	}
+	warningLog = "";
+	return true;
+}
+
 bool PatchManager::isLegacy(int level) {
 	return legacy && legacy <= level;
 }
@@ -7,6 +7,7 @@
 #include <app/common.hpp>
 #include <plugin/callbacks.hpp>
 #include <settings.hpp>
+#include <startup.hpp>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -45,16 +46,39 @@ namespace plugin {
 
 typedef void (*InitCallback)(Plugin*);
 
+/** Returns the ISA variants of plugin libraries supported by the CPU, from most to least preferred.
+The baseline variant "" is always supported.
+See ISA_VARIANTS in plugin.mk.
+*/
+static const std::vector<std::string>& getIsaVariants() {
+	static const std::vector<std::string> variants = [] {
+		std::vector<std::string> variants;
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("fma"))
+			variants.push_back("avx512");
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			variants.push_back("avx2");
+		variants.push_back("");
+		return variants;
+	}();
+	return variants;
+}
+
 static InitCallback loadLibrary(Plugin* plugin) {
-	// Load plugin library
+	// Load the most capable plugin library supported by the CPU
 	std::string libraryFilename;
+	for (const std::string& isa : getIsaVariants()) {
+		std::string suffix = (isa == "") ? "" : ("-" + isa);
 #if defined ARCH_LIN
-	libraryFilename = plugin->path + "/" + "plugin.so";
+		libraryFilename = plugin->path + "/" + "plugin" + suffix + ".so";
 #elif defined ARCH_WIN
-	libraryFilename = plugin->path + "/" + "plugin.dll";
+		libraryFilename = plugin->path + "/" + "plugin" + suffix + ".dll";
 #elif ARCH_MAC
-	libraryFilename = plugin->path + "/" + "plugin.dylib";
+		libraryFilename = plugin->path + "/" + "plugin" + suffix + ".dylib";
 #endif
+		if (system::isFile(libraryFilename))
+			break;
+	}
 
 	// Check file existence
 	if (!system::isFile(libraryFilename)) {
@@ -133,14 +157,19 @@ static Plugin* loadPlugin(std::string path) {
 		});
 
 		// Call init callback
+		std::string timerName = (path == "") ? "Core" : path;
 		InitCallback initCallback;
 		if (path == "") {
 			initCallback = core::init;
 		}
 		else {
+			startup::Timer timer("dlopen", timerName);
 			initCallback = loadLibrary(plugin);
 		}
-		initCallback(plugin);
+		{
+			startup::Timer timer("init", timerName);
+			initCallback(plugin);
+		}
 
 		// Load manifest
 		plugin->fromJson(rootJ);
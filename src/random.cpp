@@ -67,6 +67,32 @@ float normal() {
 	// return (sum - n / 2.f) / std::sqrt(n / 12.f);
 }
 
+// splitmix64
+// from http://xoroshiro.di.unimi.it/splitmix64.c
+
+static uint64_t splitmix64_next(uint64_t& x) {
+	uint64_t z = (x += 0x9e3779b97f4a7c15);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+void seedState(uint64_t state[2], uint64_t seed) {
+	// Recommended by the xoroshiro authors, since the state must not be all zeros and similar seeds should give unrelated sequences
+	state[0] = splitmix64_next(seed);
+	state[1] = splitmix64_next(seed);
+}
+
+void getState(uint64_t state[2]) {
+	state[0] = xoroshiro128plus_state[0];
+	state[1] = xoroshiro128plus_state[1];
+}
+
+void setState(const uint64_t state[2]) {
+	xoroshiro128plus_state[0] = state[0];
+	xoroshiro128plus_state[1] = state[1];
+}
+
 
 } // namespace random
 } // namespace rack
@@ -26,6 +26,14 @@ bool allowCursorLock = true;
 bool realTime = false;
 float sampleRate = 44100.0;
 int threadCount = 1;
+int engineBlockSize = 128;
+bool stickyThreads = false;
+bool loadShedding = false;
+bool delayCompensation = true;
+bool checkVoltages = false;
+bool sanitizeVoltages = false;
+bool deterministic = false;
+uint64_t randomSeed = 0;
 bool paramTooltip = false;
 bool cpuMeter = false;
 bool lockModules = false;
@@ -73,6 +81,22 @@ json_t* toJson() {
 
 	json_object_set_new(rootJ, "threadCount", json_integer(threadCount));
 
+	json_object_set_new(rootJ, "engineBlockSize", json_integer(engineBlockSize));
+
+	json_object_set_new(rootJ, "stickyThreads", json_boolean(stickyThreads));
+
+	json_object_set_new(rootJ, "loadShedding", json_boolean(loadShedding));
+
+	json_object_set_new(rootJ, "delayCompensation", json_boolean(delayCompensation));
+
+	json_object_set_new(rootJ, "checkVoltages", json_boolean(checkVoltages));
+
+	json_object_set_new(rootJ, "sanitizeVoltages", json_boolean(sanitizeVoltages));
+
+	json_object_set_new(rootJ, "deterministic", json_boolean(deterministic));
+
+	json_object_set_new(rootJ, "randomSeed", json_integer(randomSeed));
+
 	json_object_set_new(rootJ, "paramTooltip", json_boolean(paramTooltip));
 
 	json_object_set_new(rootJ, "cpuMeter", json_boolean(cpuMeter));
@@ -150,6 +174,38 @@ void fromJson(json_t* rootJ) {
 	if (threadCountJ)
 		threadCount = json_integer_value(threadCountJ);
 
+	json_t* engineBlockSizeJ = json_object_get(rootJ, "engineBlockSize");
+	if (engineBlockSizeJ)
+		engineBlockSize = json_integer_value(engineBlockSizeJ);
+
+	json_t* stickyThreadsJ = json_object_get(rootJ, "stickyThreads");
+	if (stickyThreadsJ)
+		stickyThreads = json_boolean_value(stickyThreadsJ);
+
+	json_t* loadSheddingJ = json_object_get(rootJ, "loadShedding");
+	if (loadSheddingJ)
+		loadShedding = json_boolean_value(loadSheddingJ);
+
+	json_t* delayCompensationJ = json_object_get(rootJ, "delayCompensation");
+	if (delayCompensationJ)
+		delayCompensation = json_boolean_value(delayCompensationJ);
+
+	json_t* checkVoltagesJ = json_object_get(rootJ, "checkVoltages");
+	if (checkVoltagesJ)
+		checkVoltages = json_boolean_value(checkVoltagesJ);
+
+	json_t* sanitizeVoltagesJ = json_object_get(rootJ, "sanitizeVoltages");
+	if (sanitizeVoltagesJ)
+		sanitizeVoltages = json_boolean_value(sanitizeVoltagesJ);
+
+	json_t* deterministicJ = json_object_get(rootJ, "deterministic");
+	if (deterministicJ)
+		deterministic = json_boolean_value(deterministicJ);
+
+	json_t* randomSeedJ = json_object_get(rootJ, "randomSeed");
+	if (randomSeedJ)
+		randomSeed = json_integer_value(randomSeedJ);
+
 	json_t* paramTooltipJ = json_object_get(rootJ, "paramTooltip");
 	if (paramTooltipJ)
 		paramTooltip = json_boolean_value(paramTooltipJ);
@@ -0,0 +1,129 @@
+#include <startup.hpp>
+#include <asset.hpp>
+#include <system.hpp>
+#include <string.hpp>
+#include <jansson.h>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+
+namespace rack {
+namespace startup {
+
+
+struct Record {
+	std::string category;
+	std::string name;
+	double startTime;
+	double duration;
+	int depth;
+};
+
+
+static bool recording = true;
+static std::mutex recordsMutex;
+static std::vector<Record> records;
+/** Nesting depth of the current thread's Timers */
+static thread_local int depth = 0;
+static double firstTime = NAN;
+
+
+Timer::Timer(const std::string& category, const std::string& name) {
+	std::lock_guard<std::mutex> lock(recordsMutex);
+	if (!recording) {
+		index = -1;
+		return;
+	}
+	Record record;
+	record.category = category;
+	record.name = name;
+	record.startTime = system::getTime();
+	record.duration = NAN;
+	record.depth = depth++;
+	if (std::isnan(firstTime))
+		firstTime = record.startTime;
+	index = records.size();
+	records.push_back(record);
+}
+
+
+Timer::~Timer() {
+	if (index < 0)
+		return;
+	depth--;
+	std::lock_guard<std::mutex> lock(recordsMutex);
+	// finish() clears the records, so Timers still running at that point aren't recorded.
+	if (!recording)
+		return;
+	Record& record = records[index];
+	record.duration = system::getTime() - record.startTime;
+}
+
+
+static json_t* toJson(double totalDuration) {
+	json_t* rootJ = json_object();
+	json_object_set_new(rootJ, "duration", json_real(totalDuration));
+
+	json_t* timersJ = json_array();
+	for (const Record& record : records) {
+		json_t* timerJ = json_object();
+		json_object_set_new(timerJ, "category", json_string(record.category.c_str()));
+		json_object_set_new(timerJ, "name", json_string(record.name.c_str()));
+		json_object_set_new(timerJ, "start", json_real(record.startTime - firstTime));
+		json_object_set_new(timerJ, "duration", json_real(record.duration));
+		json_object_set_new(timerJ, "depth", json_integer(record.depth));
+		json_array_append_new(timersJ, timerJ);
+	}
+	json_object_set_new(rootJ, "timers", timersJ);
+	return rootJ;
+}
+
+
+void finish() {
+	std::lock_guard<std::mutex> lock(recordsMutex);
+	if (!recording)
+		return;
+	recording = false;
+	double totalDuration = std::isnan(firstTime) ? 0.0 : system::getTime() - firstTime;
+
+	// Write report
+	json_t* rootJ = toJson(totalDuration);
+	DEFER({
+		json_decref(rootJ);
+	});
+	if (json_dump_file(rootJ, asset::startupReportPath.c_str(), JSON_INDENT(2) | JSON_REAL_PRECISION(6))) {
+		WARN("Could not write startup report to %s", asset::startupReportPath.c_str());
+	}
+
+	// Log phases, totals of each category, and the slowest steps outside of phases
+	INFO("Startup took %.3f s, report written to %s", totalDuration, asset::startupReportPath.c_str());
+	std::map<std::string, std::pair<int, double>> categoryTotals;
+	std::vector<const Record*> steps;
+	for (const Record& record : records) {
+		if (record.category == "phase") {
+			INFO("Startup phase %s: %.3f s", record.name.c_str(), record.duration);
+			continue;
+		}
+		auto& total = categoryTotals[record.category];
+		total.first++;
+		total.second += record.duration;
+		steps.push_back(&record);
+	}
+	for (const auto& pair : categoryTotals) {
+		INFO("Startup %s: %d in %.3f s", pair.first.c_str(), pair.second.first, pair.second.second);
+	}
+	std::sort(steps.begin(), steps.end(), [](const Record* a, const Record* b) {
+		return a->duration > b->duration;
+	});
+	const size_t slowestCount = 10;
+	for (size_t i = 0; i < std::min(steps.size(), slowestCount); i++) {
+		INFO("Startup slowest %s %s: %.3f s", steps[i]->category.c_str(), steps[i]->name.c_str(), steps[i]->duration);
+	}
+	records.clear();
+}
+
+
+} // namespace startup
+} // namespace rack
@@ -2,6 +2,7 @@
 #include <string.hpp>
 
 #include <thread>
+#include <chrono>
 #include <regex>
 #include <dirent.h>
 #include <sys/stat.h>
@@ -12,6 +13,8 @@
 	#include <sched.h>
 	#include <execinfo.h> // for backtrace and backtrace_symbols
 	#include <unistd.h> // for execl
+	#include <time.h> // for clock_nanosleep
+	#include <errno.h>
 	#include <sys/utsname.h>
 #endif
 
@@ -219,6 +222,31 @@ double getThreadTime() {
 }
 
 
+double getTime() {
+#if defined ARCH_LIN
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+void sleepUntil(double time) {
+#if defined ARCH_LIN
+	struct timespec ts;
+	ts.tv_sec = (time_t) time;
+	ts.tv_nsec = (long) ((time - ts.tv_sec) * 1e9);
+	// Resume sleeping if interrupted by a signal
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+#else
+	auto duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time));
+	std::this_thread::sleep_until(std::chrono::steady_clock::time_point(duration));
+#endif
+}
+
+
 std::string getStackTrace() {
 	int stackLen = 128;
 	void* stack[stackLen];
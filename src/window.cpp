@@ -7,6 +7,7 @@
 #include <app.hpp>
 #include <patch.hpp>
 #include <settings.hpp>
+#include <startup.hpp>
 #include <plugin.hpp> // used in Window::screenshot
 #include <system.hpp> // used in Window::screenshot
 
@@ -542,6 +543,7 @@ float Window::getLastFrameRate() {
 std::shared_ptr<Font> Window::loadFont(const std::string& filename) {
 	auto sp = fontCache[filename].lock();
 	if (!sp) {
+		startup::Timer timer("font", filename);
 		fontCache[filename] = sp = std::make_shared<Font>();
 		sp->loadFile(filename, vg);
 	}
@@ -551,6 +553,7 @@ std::shared_ptr<Font> Window::loadFont(const std::string& filename) {
 std::shared_ptr<Image> Window::loadImage(const std::string& filename) {
 	auto sp = imageCache[filename].lock();
 	if (!sp) {
+		startup::Timer timer("image", filename);
 		imageCache[filename] = sp = std::make_shared<Image>();
 		sp->loadFile(filename, vg);
 	}
@@ -560,6 +563,7 @@ std::shared_ptr<Image> Window::loadImage(const std::string& filename) {
 std::shared_ptr<Svg> Window::loadSvg(const std::string& filename) {
 	auto sp = svgCache[filename].lock();
 	if (!sp) {
+		startup::Timer timer("svg", filename);
 		svgCache[filename] = sp = std::make_shared<Svg>();
 		sp->loadFile(filename);
 	}